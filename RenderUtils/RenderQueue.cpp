@@ -0,0 +1,119 @@
+#include <algorithm>
+#include "RenderQueue.h"
+
+/*
+ * Constructor
+ */
+RenderQueue::RenderQueue()
+    : commands(), stats()
+{
+}
+
+/*
+ * Add
+ */
+void RenderQueue::Add(
+    Shader*      shader,
+    VertexArray* vertexArray,
+    GLenum       mode,
+    int          instances,
+    Texture*     texture,
+    int          textureUnit,
+    Setup        setup,
+    void*        data)
+{
+    Command command;
+    command.shader = shader;
+    command.vertexArray = vertexArray;
+    command.texture = texture;
+    command.textureUnit = textureUnit;
+    command.mode = mode;
+    command.instances = instances;
+    command.setup = setup;
+    command.data = data;
+    commands.push_back(command);
+}
+
+/*
+ * State order
+ */
+bool RenderQueue::StateOrder(const Command& a, const Command& b)
+{
+    if (a.shader->GetProgramId() != b.shader->GetProgramId())
+    {
+        return a.shader->GetProgramId() < b.shader->GetProgramId();
+    }
+    if (a.vertexArray != b.vertexArray)
+    {
+        return a.vertexArray < b.vertexArray;
+    }
+    GLuint textureA = a.texture ? a.texture->GetID() : 0;
+    GLuint textureB = b.texture ? b.texture->GetID() : 0;
+    return textureA < textureB;
+}
+
+/*
+ * Submit
+ */
+void RenderQueue::Submit()
+{
+    // Group commands sharing state, keeping their order otherwise
+    std::stable_sort(commands.begin(), commands.end(), StateOrder);
+
+    stats = Stats();
+    Shader* shader = NULL;
+    VertexArray* vertexArray = NULL;
+    for (std::vector<Command>::iterator it = commands.begin();
+         it != commands.end();
+         it++)
+    {
+        // Binding a shader invalidates the vertex array binding,
+        // since vertex arrays keep one VAO per shader
+        if (it->shader != shader)
+        {
+            it->shader->Bind();
+            shader = it->shader;
+            vertexArray = NULL;
+            stats.programBinds++;
+        }
+        if (it->vertexArray != vertexArray)
+        {
+            it->vertexArray->Bind(*shader);
+            vertexArray = it->vertexArray;
+            stats.vertexArrayBinds++;
+        }
+        if (it->texture != NULL &&
+            !(it->texture->IsBound() && it->texture->GetTextureUnit() == it->textureUnit))
+        {
+            it->texture->Bind(it->textureUnit);
+            stats.textureBinds++;
+        }
+
+        if (it->setup != NULL)
+        {
+            it->setup(*shader, it->data);
+        }
+
+        if (it->instances > 0)
+        {
+            vertexArray->DrawInstanced(it->mode, it->instances);
+        }
+        else
+        {
+            vertexArray->Draw(it->mode);
+        }
+        stats.draws++;
+    }
+
+    // Unbind the program and vertex array, so vertex arrays can be changed
+    // before the next frame.  Textures stay bound to their units.
+    if (vertexArray != NULL)
+    {
+        VertexArray::Unbind();
+    }
+    if (shader != NULL)
+    {
+        Shader::Unbind();
+    }
+    commands.clear();
+}
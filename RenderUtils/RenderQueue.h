@@ -0,0 +1,126 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <GL/glew.h>
+#include <vector>
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexArray.h"
+
+/**
+ * \brief Collects the draws of a frame and submits them with few state changes
+ *
+ * Drawing each object on its own binds its shader, vertex array and
+ * texture and unbinds them again afterwards.  A RenderQueue instead keeps
+ * the draws of a frame as commands, sorts them by shader program, vertex
+ * array and texture, and only binds what differs from the previous
+ * command.  The shader program and vertex array are unbound once at the
+ * end.  Textures stay bound to their units, so a texture used again by
+ * the next frame is not bound again.
+ *
+ * Commands with equal state keep the order they were added in.  Uniforms
+ * that differ between draws with the same shader are set by a setup
+ * function that is called right before the draw, with the shader bound.
+ */
+class RenderQueue
+{
+public:
+
+    /**
+     * \brief Sets per-draw uniforms on the bound shader
+     *
+     * \param[in] shader - Shader of the command, currently bound
+     * \param[in] data   - Pointer given with the command
+     */
+    typedef void (*Setup)(Shader& shader, void* data);
+
+    /**
+     * \brief Counters of the last submitted frame
+     */
+    struct Stats
+    {
+        int draws;            //!< Draw calls
+        int programBinds;     //!< Shader programs bound
+        int vertexArrayBinds; //!< Vertex arrays bound
+        int textureBinds;     //!< Textures bound
+
+        Stats()
+            : draws(0), programBinds(0), vertexArrayBinds(0), textureBinds(0)
+        {
+        }
+    };
+
+    /**
+     * \brief Creates an empty queue
+     */
+    RenderQueue();
+
+    /**
+     * \brief Adds a draw to the queue
+     *
+     * Nothing is drawn until Submit.  The shader, vertex array and texture
+     * must stay alive until then.
+     *
+     * \param[in] shader      - Shader to draw with
+     * \param[in] vertexArray - Vertex data to draw
+     * \param[in] mode        - Type of primitive, as in VertexArray::Draw
+     * \param[in] instances   - Number of instances for VertexArray::DrawInstanced,
+     *                          or 0 for a plain draw
+     * \param[in] texture     - Texture to bind, or NULL for none
+     * \param[in] textureUnit - Texture unit to bind the texture to
+     * \param[in] setup       - Function to set per-draw uniforms, or NULL
+     * \param[in] data        - Passed to setup
+     */
+    void Add(Shader*      shader,
+             VertexArray* vertexArray,
+             GLenum       mode,
+             int          instances = 0,
+             Texture*     texture = NULL,
+             int          textureUnit = 0,
+             Setup        setup = NULL,
+             void*        data = NULL);
+
+    /**
+     * \brief Draws all queued commands and empties the queue
+     *
+     * Counts the draws and binds for GetStats.
+     */
+    void Submit();
+
+    /**
+     * \brief Gets the counters of the last Submit
+     *
+     * \return Draws and binds of the last submitted frame
+     */
+    inline const Stats& GetStats() const { return stats; }
+
+private:
+
+    /**
+     * \brief A queued draw
+     */
+    struct Command
+    {
+        Shader*      shader;
+        VertexArray* vertexArray;
+        Texture*     texture;
+        int          textureUnit;
+        GLenum       mode;
+        int          instances;
+        Setup        setup;
+        void*        data;
+    };
+
+    /**
+     * \brief Orders commands by program, vertex array and texture
+     */
+    static bool StateOrder(const Command& a, const Command& b);
+
+    std::vector<Command> commands; //!< Draws of the current frame
+    Stats stats;                   //!< Counters of the last submitted frame
+
+    RenderQueue(const RenderQueue&);            //!< No copy constructor
+    RenderQueue& operator=(const RenderQueue&); //!< No assignment operator
+};
+
+#endif
@@ -15,6 +15,7 @@ Shader::Shader(const char* vertexShaderPath,
                const char* fragShaderPath,
                const char* geoShaderPath)
                : uniforms(),
+               uniformLocations(1, -1),
                attributes()
 {
     assert(vertexShaderPath && fragShaderPath);
@@ -35,6 +36,9 @@ Shader::Shader(const char* vertexShaderPath,
     if (programId != 0)
     {
         GetShaderInfo();
+
+        // Connect the shared camera block, if the shader uses it
+        BindUniformBlock("Camera", CAMERA_BLOCK_BINDING);
     }
 }
 
@@ -168,6 +172,29 @@ GLint Shader::GetUniformLocation(const std::string& name) const
     }
 }
 
+/*
+ * Get uniform handle
+ */
+Shader::Uniform Shader::GetUniformHandle(const char* name) const
+{
+    uniformLocations.push_back(GetUniformLocation(name));
+    return Uniform((int)uniformLocations.size() - 1);
+}
+
+/*
+ * Bind uniform block
+ */
+bool Shader::BindUniformBlock(const char* name, GLuint binding)
+{
+    GLuint index = glGetUniformBlockIndex(programId, name);
+    if (index == GL_INVALID_INDEX)
+    {
+        return false;
+    }
+    glUniformBlockBinding(programId, index, binding);
+    return true;
+}
+
 /*
  * Set uniform 1f
  */
@@ -336,6 +363,174 @@ void Shader::SetUniform(const char* name, const mat4& matrix)
     }
 }
 
+/*
+ * Set uniform 1f handle
+ */
+void Shader::SetUniform(Uniform uniform, float v0)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform1f(uniformLocations[uniform.index], v0);
+    }
+}
+
+/*
+ * Set uniform 2f handle
+ */
+void Shader::SetUniform(Uniform uniform, float v0, float v1)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform2f(uniformLocations[uniform.index], v0, v1);
+    }
+}
+
+/*
+ * Set uniform 3f handle
+ */
+void Shader::SetUniform(Uniform uniform, float v0, float v1, float v2)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform3f(uniformLocations[uniform.index], v0, v1, v2);
+    }
+}
+
+/*
+ * Set uniform 4f handle
+ */
+void Shader::SetUniform(Uniform uniform, float v0, float v1, float v2, float v3)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform4f(uniformLocations[uniform.index], v0, v1, v2, v3);
+    }
+}
+
+/*
+ * Set uniform 1i handle
+ */
+void Shader::SetUniform(Uniform uniform, int v0)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform1i(uniformLocations[uniform.index], v0);
+    }
+}
+
+/*
+ * Set uniform 2i handle
+ */
+void Shader::SetUniform(Uniform uniform, int v0, int v1)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform2i(uniformLocations[uniform.index], v0, v1);
+    }
+}
+
+/*
+ * Set uniform 3i handle
+ */
+void Shader::SetUniform(Uniform uniform, int v0, int v1, int v2)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform3i(uniformLocations[uniform.index], v0, v1, v2);
+    }
+}
+
+/*
+ * Set uniform 4i handle
+ */
+void Shader::SetUniform(Uniform uniform, int v0, int v1, int v2, int v3)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform4i(uniformLocations[uniform.index], v0, v1, v2, v3);
+    }
+}
+
+/*
+ * Set uniform vec2 handle
+ */
+void Shader::SetUniform(Uniform uniform, const vec2& vec2)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform2f(uniformLocations[uniform.index], vec2[0], vec2[1]);
+    }
+}
+
+/*
+ * Set uniform vec3 handle
+ */
+void Shader::SetUniform(Uniform uniform, const vec3& vec3)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform3f(uniformLocations[uniform.index], vec3[0], vec3[1], vec3[2]);
+    }
+}
+
+/*
+ * Set uniform vec4 handle
+ */
+void Shader::SetUniform(Uniform uniform, const vec4& vec4)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniform4f(uniformLocations[uniform.index], vec4[0], vec4[1], vec4[2], vec4[3]);
+    }
+}
+
+/*
+ * Set uniform mat2 handle
+ */
+void Shader::SetUniform(Uniform uniform, const mat2& matrix)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniformMatrix2fv(uniformLocations[uniform.index], 1, GL_TRUE, matrix);
+    }
+}
+
+/*
+ * Set uniform mat3 handle
+ */
+void Shader::SetUniform(Uniform uniform, const mat3& matrix)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniformMatrix3fv(uniformLocations[uniform.index], 1, GL_TRUE, matrix);
+    }
+}
+
+/*
+ * Set uniform mat4 handle
+ */
+void Shader::SetUniform(Uniform uniform, const mat4& matrix)
+{
+    assert(IsBound());
+    if (programId != 0)
+    {
+        glUniformMatrix4fv(uniformLocations[uniform.index], 1, GL_TRUE, matrix);
+    }
+}
+
 /*
  * Get parameter info for the shader
  */
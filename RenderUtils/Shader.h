@@ -4,6 +4,7 @@
 #include <GL/glew.h>
 #include <map>
 #include <string>
+#include <vector>
 #include <Angel.h>
 
 // Forward declaration to prevent circular include loop
@@ -32,6 +33,14 @@ class VertexArray;
  * shader program.  Uniforms retain their values even when a shader program
  * is no longer active
  *
+ * Uniforms shared by every shader are better kept in a uniform block, whose
+ * values live in a UniformBuffer.  A shader that declares the block
+ *
+ *     layout(std140, row_major) uniform Camera { mat4 view; mat4 projection; };
+ *
+ * is bound to CAMERA_BLOCK_BINDING when it is created, so updating one
+ * buffer once per frame sets the camera for all of them.
+ *
  * \author Jonathan Henze
  */
 class Shader
@@ -70,6 +79,46 @@ public:
         GLint   location; //!< Location for this parameter
     };
 
+    /**
+     * \brief Handle of a uniform variable resolved by GetUniformHandle
+     *
+     * Setting a uniform through a handle skips building a string and
+     * searching the uniform map, which SetUniform by name does on every
+     * call.  A default constructed handle refers to no uniform, and
+     * setting it has no effect.  Handles are only valid for the shader
+     * that created them.
+     */
+    class Uniform
+    {
+    public:
+
+        /**
+         * \brief Creates a handle that refers to no uniform
+         */
+        Uniform()
+            : index(0)
+        {
+        }
+
+    private:
+        friend class Shader;
+
+        /**
+         * \brief Creates a handle for an entry in the shader's location array
+         */
+        explicit Uniform(int index)
+            : index(index)
+        {
+        }
+
+        int index; //!< Index into Shader::uniformLocations
+    };
+
+    /**
+     * \brief Binding point of the shared Camera uniform block
+     */
+    static const GLuint CAMERA_BLOCK_BINDING = 0;
+
     typedef ParamInfo UniformInfo;   //!< Structure of uniform variable info
     typedef ParamInfo AttributeInfo; //!< Structure of attribute variable info
     typedef std::map<
@@ -151,6 +200,33 @@ public:
     GLint GetUniformLocation(const char* name) const;
     GLint GetUniformLocation(const std::string& name) const;
 
+    /**
+     * \brief Resolves the name of a uniform variable into a handle
+     *
+     * Meant to be called once, when setting up, for uniforms that are set
+     * often.  Names are resolved like GetUniformLocation, so array elements
+     * and structure members ("lights[2].color") work as well.
+     *
+     * \param[in] name - Name of the variable, exactly as written in the shader file
+     *
+     * \return Handle for the SetUniform overloads taking a Uniform
+     */
+    Uniform GetUniformHandle(const char* name) const;
+
+    /**
+     * \brief Reads a uniform block from a binding point
+     *
+     * The block's values then come from the UniformBuffer attached to the
+     * binding point.  The binding is part of the shader program and stays
+     * until changed.
+     *
+     * \param[in] name    - Name of the block, exactly as written in the shader file
+     * \param[in] binding - Binding point
+     *
+     * \return Whether the shader has a block by that name
+     */
+    bool BindUniformBlock(const char* name, GLuint binding);
+
     /**
      * \brief Sets the value of a uniform variable
      *
@@ -201,6 +277,32 @@ public:
     void SetUniform(const char* name, const mat3& matrix);
     void SetUniform(const char* name, const mat4& matrix);
 
+    /**
+     * \brief Sets the value of a uniform variable through a handle
+     *
+     * Same as setting it by name, without looking the name up.
+     * The shader must be currently bound, or this will fail
+     *
+     * \param[in] uniform - Handle from GetUniformHandle of this shader
+     * \param[in] v#      - Components of a 1-4D float or int uniform
+     * \param[in] vec#    - Vector value for the uniform
+     * \param[in] matrix  - Matrix value for the uniform
+     */
+    void SetUniform(Uniform uniform, float v0);
+    void SetUniform(Uniform uniform, float v0, float v1);
+    void SetUniform(Uniform uniform, float v0, float v1, float v2);
+    void SetUniform(Uniform uniform, float v0, float v1, float v2, float v3);
+    void SetUniform(Uniform uniform, int v0);
+    void SetUniform(Uniform uniform, int v0, int v1);
+    void SetUniform(Uniform uniform, int v0, int v1, int v2);
+    void SetUniform(Uniform uniform, int v0, int v1, int v2, int v3);
+    void SetUniform(Uniform uniform, const vec2& vec2);
+    void SetUniform(Uniform uniform, const vec3& vec3);
+    void SetUniform(Uniform uniform, const vec4& vec4);
+    void SetUniform(Uniform uniform, const mat2& matrix);
+    void SetUniform(Uniform uniform, const mat3& matrix);
+    void SetUniform(Uniform uniform, const mat4& matrix);
+
     /**
      * \brief Gets the OpenGL ID of the shader program
      *
@@ -299,6 +401,12 @@ private:
      */
     mutable UniformMap uniforms;
 
+    /**
+     * \brief Locations of the uniforms resolved into handles, indexed by
+     *        Uniform::index.  Entry 0 is -1 for handles that refer to no uniform
+     */
+    mutable std::vector<GLint> uniformLocations;
+
     /**
      * \brief Information about the attributes mapped by the variable name
      */
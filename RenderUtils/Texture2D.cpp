@@ -236,6 +236,38 @@ Texture2D::~Texture2D()
     // Nothing to do here, it is all handled in the base destructor
 }
 
+/*
+ * Update
+ */
+void Texture2D::Update(const GLvoid* pixels, int x, int y, int width, int height)
+{
+    // Debug assertions
+    assert(pixels);
+    assert(x >= 0 && y >= 0 && width > 0 && height > 0);
+    assert(x + width <= this->width && y + height <= this->height);
+
+    Bind(IsBound() ? GetTextureUnit() : 0);
+    glTexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        x,
+        y,
+        width,
+        height,
+        imageFormat,
+        dataType,
+        pixels);
+
+    // Keep the mip maps in step with the image
+    if (minFilter == GL_NEAREST_MIPMAP_NEAREST ||
+        minFilter == GL_NEAREST_MIPMAP_LINEAR  ||
+        minFilter == GL_LINEAR_MIPMAP_NEAREST  ||
+        minFilter == GL_LINEAR_MIPMAP_LINEAR)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
 /*
  * Init texture object
  */
@@ -173,6 +173,22 @@ public:
      */
     ~Texture2D();
 
+    /**
+     * \brief Replaces a rectangle of the texture with new pixel data
+     *
+     * Uploads the pixels with glTexSubImage2D, in the format and data type
+     * the texture was created with.  The texture is bound to the texture
+     * unit it was last bound to, or unit 0.  Mip maps are generated again
+     * if the min filter uses them.
+     *
+     * \param[in] pixels - Pixel data, laid out like the constructor's data
+     * \param[in] x      - Left column of the rectangle
+     * \param[in] y      - Bottom row of the rectangle
+     * \param[in] width  - Width of the rectangle in pixels
+     * \param[in] height - Height of the rectangle in pixels
+     */
+    void Update(const GLvoid* pixels, int x, int y, int width, int height);
+
 protected:
 
     /**
@@ -0,0 +1,35 @@
+#include "UniformBuffer.h"
+
+/*
+ * Constructor
+ */
+UniformBuffer::UniformBuffer(GLuint binding, int size)
+    : bufferId(0), binding(binding)
+{
+    // Allocate the buffer without data, it is filled in by Update
+    glGenBuffers(1, &bufferId);
+    glBindBuffer(GL_UNIFORM_BUFFER, bufferId);
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Attach the whole buffer to the binding point
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, bufferId);
+}
+
+/*
+ * Destructor
+ */
+UniformBuffer::~UniformBuffer()
+{
+    glDeleteBuffers(1, &bufferId);
+}
+
+/*
+ * Update
+ */
+void UniformBuffer::Update(const void* data, int size, int offset)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, bufferId);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
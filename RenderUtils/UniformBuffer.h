@@ -0,0 +1,59 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <GL/glew.h>
+
+/**
+ * \brief Class for managing an OpenGL uniform buffer object (UBO)
+ *
+ * A uniform buffer holds the values of a uniform block.  It is attached
+ * to a numbered binding point, and every shader program whose block is
+ * bound to the same point (see Shader::BindUniformBlock) reads the same
+ * values.  Data shared by many shaders, like the camera matrices, is then
+ * uploaded once instead of once per shader.
+ *
+ * The data must follow the std140 layout of the block in the shader.
+ */
+class UniformBuffer
+{
+public:
+
+    /**
+     * \brief Creates a uniform buffer and attaches it to a binding point
+     *
+     * \param[in] binding - Binding point of the uniform block
+     * \param[in] size    - Size of the block in bytes
+     */
+    UniformBuffer(GLuint binding, int size);
+
+    /**
+     * \brief Uniform buffer destructor
+     */
+    ~UniformBuffer();
+
+    /**
+     * \brief Replaces part of the buffer's data
+     *
+     * \param[in] data   - New data
+     * \param[in] size   - Number of bytes to replace
+     * \param[in] offset - Byte offset of the first replaced byte
+     */
+    void Update(const void* data, int size, int offset = 0);
+
+    /**
+     * \brief Gets the binding point the buffer is attached to
+     *
+     * \return Binding point of the buffer
+     */
+    inline GLuint GetBinding() const { return binding; }
+
+private:
+
+    GLuint bufferId; //!< OpenGL ID of the buffer
+    GLuint binding;  //!< Binding point of the buffer
+
+    UniformBuffer(const UniformBuffer&);            //!< No copy constructor
+    UniformBuffer& operator=(const UniformBuffer&); //!< No assignment operator
+};
+
+#endif
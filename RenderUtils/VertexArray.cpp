@@ -259,6 +259,67 @@ void VertexArray::AddAttribute(const char* name, const unsigned char* data, int
         GL_UNSIGNED_BYTE);
 }
 
+/*
+ * Add Instance Attribute vec4
+ */
+void VertexArray::AddInstanceAttribute(const char* name, const vec4* data, int length)
+{
+    AddAttributeCommon(
+        name, 
+        (float*)&(data[0].x), // Point to the first component of the first vector
+        4, 
+        length, 
+        sizeof(vec4) - 4*sizeof(float), // Ideally 0
+        GL_FLOAT,
+        1);
+}
+
+/*
+ * Add Instance Attribute float
+ */
+void VertexArray::AddInstanceAttribute(const char* name, const float* data, int numComponents, int length)
+{
+    AddAttributeCommon(
+        name, 
+        data,
+        numComponents,
+        length,
+        0,
+        GL_FLOAT,
+        1);
+}
+
+/*
+ * Add Instance Attribute unsigned char
+ */
+void VertexArray::AddInstanceAttribute(const char* name, const unsigned char* data, int numComponents, int length)
+{
+    AddAttributeCommon(
+        name, 
+        data,
+        numComponents,
+        length,
+        0,
+        GL_UNSIGNED_BYTE,
+        1);
+}
+
+/*
+ * Update Attribute float
+ */
+void VertexArray::UpdateAttribute(const char* name, const float* data, int first, int length)
+{
+    UpdateAttributeCommon(name, data, first, length);
+}
+
+/*
+ * Update Attribute unsigned char
+ */
+void VertexArray::UpdateAttribute(const char* name, const unsigned char* data, int first, int length)
+{
+    UpdateAttributeCommon(name, data, first, length);
+}
+
 /*
  * Add Attribute common
  */
@@ -269,19 +330,24 @@ void VertexArray::AddAttributeCommon(
     int         numComponents, 
     int         length,
     GLsizei     stride,
-    GLenum      type)
+    GLenum      type,
+    GLuint      divisor)
 {
     // We cannot be currently bound for drawing while making changes to the
     // data in our VertexArray
     assert(!IsBound());
 
-    // All attributes added must have the same number of vertices
-    assert(numVertices == 0 || numVertices == length);
-
-    // If this is our first attribute, save the number of vertices
-    if (numVertices == 0)
+    // All per-vertex attributes added must have the same number of vertices.
+    // Per-instance attributes have one element per instance instead
+    if (divisor == 0)
     {
-        numVertices = length;
+        assert(numVertices == 0 || numVertices == length);
+
+        // If this is our first attribute, save the number of vertices
+        if (numVertices == 0)
+        {
+            numVertices = length;
+        }
     }
 
     std::string str(name);
@@ -296,7 +362,8 @@ void VertexArray::AddAttributeCommon(
 
         if (attribute.type != type ||
             attribute.numComponents != numComponents ||
-            attribute.stride != stride)
+            attribute.stride != stride ||
+            attribute.divisor != divisor)
         {
             // The attribute data is being replaced with data of a different
             // format, invalidating previously created VAOs
@@ -319,17 +386,45 @@ void VertexArray::AddAttributeCommon(
     glBufferData(GL_ARRAY_BUFFER,
         numComponents * length * sizeof(T),
         data,
-        GL_STATIC_DRAW);
+        divisor == 0 ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
     
     // Save the properites of the data
     attribute.type = type;
     attribute.numComponents = numComponents;
     attribute.stride = stride;
+    attribute.divisor = divisor;
 
     // Save the attribute to our map
     attributes[str] = attribute;
 }
 
+/*
+ * Update Attribute common
+ */
+template<class T>
+void VertexArray::UpdateAttributeCommon(
+    const char* name, 
+    const T*    data, 
+    int         first, 
+    int         length)
+{
+    // We cannot be currently bound for drawing while making changes to the
+    // data in our VertexArray
+    assert(!IsBound());
+
+    // The attribute must already have a buffer to write into
+    std::string str(name);
+    assert(attributes.count(str) != 0);
+    const Attribute& attribute = attributes[str];
+
+    // Copy only the range, leaving the rest of the buffer as it is.
+    // The format is unchanged, so the VAOs stay valid
+    GLsizeiptr size = attribute.numComponents * sizeof(T);
+    glBindBuffer(GL_ARRAY_BUFFER, attribute.bufferId);
+    glBufferSubData(GL_ARRAY_BUFFER, first * size, length * size, data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 /*
  * Generate a vertex array object
  */
@@ -389,6 +484,9 @@ void VertexArray::GenerateVAO(const Shader& shader)
             GL_FALSE,
             attribute.stride,
             0);
+
+        // Step per vertex or per instance
+        glVertexAttribDivisor((GLuint)location, attribute.divisor);
     }
 
     // Unbind the last attribute buffer
@@ -499,3 +597,22 @@ void VertexArray::Draw(GLenum mode) const
     }
 }
 
+
+/*
+ * Draw instanced
+ */
+void VertexArray::DrawInstanced(GLenum mode, int instances) const
+{
+    // We must be bound
+    assert(IsBound());
+
+    // Use indexed rendering if we can, otherwise use sequential rendering
+    if (HasIndices())
+    {
+        glDrawElementsInstanced(mode, NumIndices(), IndicesType(), NULL, instances);
+    }
+    else
+    {
+        glDrawArraysInstanced(mode, 0, NumVertices(), instances);
+    }
+}
@@ -101,6 +101,42 @@ public:
     void AddAttribute(const char* name, const unsigned short* data, int numComponents, int length);
     void AddAttribute(const char* name, const unsigned char*  data, int numComponents, int length);
 
+    /**
+     * \brief Adds a per-instance attribute to the vertex array
+     *
+     * Works like AddAttribute, except that the attribute advances once per
+     * instance in DrawInstanced instead of once per vertex.  Its length is
+     * the number of instances, which does not have to match the number of
+     * vertices.  Instance data is usually refilled every frame, so the
+     * buffer is created for dynamic use.
+     *
+     * \param[in] name          - Name of the attribute exactly as it appears
+     *                            in the shader source
+     * \param[in] data          - Data for the attribute
+     * \param[in] numComponents - Number of components per element
+     * \param[in] length        - Number of instances in the data array
+     */
+    void AddInstanceAttribute(const char* name, const vec4* data, int length);
+    void AddInstanceAttribute(const char* name, const float* data, int numComponents, int length);
+    void AddInstanceAttribute(const char* name, const unsigned char* data, int numComponents, int length);
+
+    /**
+     * \brief Replaces part of an attribute's data
+     *
+     * The vertex array must not be bound while calling this.  The attribute
+     * must have been added before with the same type, and the range must
+     * lie within the data given then.  Only the range is copied to the
+     * buffer, so small changes to large attributes are cheap.
+     *
+     * \param[in] name   - Name of the attribute exactly as it appears
+     *                     in the shader source
+     * \param[in] data   - New data for the elements in the range
+     * \param[in] first  - Index of the first element to replace
+     * \param[in] length - Number of elements to replace
+     */
+    void UpdateAttribute(const char* name, const float* data, int first, int length);
+    void UpdateAttribute(const char* name, const unsigned char* data, int first, int length);
+
     /**
      * \brief Adds indices to the vertex array for indexed rendering
      *
@@ -134,6 +170,18 @@ public:
      */
     void Draw(GLenum mode) const;
 
+    /**
+     * \brief Draws several instances of the vertex data in one draw call
+     *
+     * Same as Draw, but the vertex data is drawn once for each instance.
+     * Attributes added with AddInstanceAttribute take their next element for
+     * each instance, so they must hold at least that many elements.
+     *
+     * \param[in] mode      - Type of primitive to use while drawing, as in Draw
+     * \param[in] instances - Number of instances to draw
+     */
+    void DrawInstanced(GLenum mode, int instances) const;
+
     /**
      * \brief Gets the number of vertices for the vertex array
      *
@@ -204,11 +252,16 @@ private:
          */
         GLsizei stride;
 
+        /**
+         * \brief Number of instances that share each element, 0 for per-vertex data
+         */
+        GLuint divisor;
+
         /**
          * \brief Default constructor
          */
         Attribute()
-            : bufferId(0)
+            : bufferId(0), divisor(0)
         {
         }
     };
@@ -315,9 +368,10 @@ private:
      *
      * \tparam T - Primitive type for a component in the attribute
      *
-     * \param[in] name - Name of the attribute
-     * \param[in] data - Data for the attribute
-     * \param[in] type - One of: GL_BYTE,
+     * \param[in] name    - Name of the attribute
+     * \param[in] data    - Data for the attribute
+     * \param[in] divisor - 0 for per-vertex data, 1 for per-instance data
+     * \param[in] type    - One of: GL_BYTE,
      *                           GL_UNSIGNED_BYTE,
      *                           GL_SHORT,
      *                           GL_UNSIGNED_SHORT,
@@ -334,7 +388,21 @@ private:
         int numComponents, 
         int length,
         GLsizei stride,
-        GLenum type);
+        GLenum type,
+        GLuint divisor = 0);
+
+    /**
+     * \brief Common method for replacing part of an attribute
+     *
+     * \tparam T - Primitive type for a component in the attribute
+     *
+     * \param[in] name   - Name of the attribute
+     * \param[in] data   - New data for the range
+     * \param[in] first  - First element of the range
+     * \param[in] length - Number of elements in the range
+     */
+    template<class T>
+    void UpdateAttributeCommon(const char* name, const T* data, int first, int length);
 
     /**
      * \brief Common method for adding indices
@@ -0,0 +1,563 @@
+#include "bidirectional.h"
+#include "pruneTable.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+typedef bidirectionalSolver::packedState packedState;
+
+//States within each depth of solved, in face turns
+static const int ballSize[7] = { 1, 19, 262, 3502, 46741, 621649, 8240087 };
+
+//Corner states within each depth of solved
+static const int cornerBallSize[8] = { 1, 19, 262, 3136, 31136, 236552, 1405068, 6807696 };
+
+//Corner distances are kept up to this depth, 1,405,068 states in 16 MB
+static const int CORNER_LIMIT = 6;
+
+//Bits above the packed corners hold the move that reached a stored state
+static const unsigned long long STATE_MASK = ( 1ULL << 40 ) - 1;
+static const int MOVE_SHIFT = 40;
+static const int NO_MOVE = 31;
+static const unsigned long long OCCUPIED = 1ULL << 63;
+
+//Phase 1 coordinate sizes and corner permutations (see cubieCube)
+enum { NUM_TWIST = 2187, NUM_FLIP = 2048, NUM_SLICE = 495, NUM_CORNER_PERM = 40320 };
+
+/*
+ * Slot each piece comes from and the twist/flip it gains, per move, and
+ * move and distance tables of the phase 1 coordinates.  Built once.
+ */
+static unsigned char cornerFrom[18][8], cornerTwist[18][8];
+static unsigned char edgeFrom[18][12], edgeFlip[18][12];
+static unsigned short twistMove[NUM_TWIST][18];
+static unsigned short flipMove[NUM_FLIP][18];
+static unsigned short sliceMove[NUM_SLICE][18];
+static unsigned short cornerPermMove[NUM_CORNER_PERM][18];
+static unsigned char * sliceTwistDistance;	//4 bits per entry
+static unsigned char * sliceFlipDistance;
+static bool tablesBuilt = false;
+
+static inline int getNibble( const unsigned char * table, int index ) {
+	return ( table[index >> 1] >> ( ( index & 1 ) << 2 ) ) & 15;
+}
+
+/*
+ * Neighbours of slice * size + coordinate under the 18 moves, for
+ * pruneTable.
+ */
+struct sliceMoves {
+	const unsigned short ( *move )[18];
+	int size;
+};
+
+static int expandSlice( int index, int * out, const void * data ) {
+	const sliceMoves & p = *(const sliceMoves *)data;
+	int slice = index / p.size, coord = index % p.size;
+	for( int m = 0; m < 18; m++ ) {
+		out[m] = sliceMove[slice][m] * p.size + p.move[coord][m];
+	}
+	return 18;
+}
+
+static unsigned char * buildDistance( const unsigned short ( *move )[18], int size, const char * name ) {
+	sliceMoves moves = { move, size };
+	unsigned char * table = new unsigned char[( NUM_SLICE * size + 1 ) / 2];
+	pruneTable::fill( table, NUM_SLICE * size, 0, expandSlice, &moves, name );
+	return table;
+}
+
+static void buildTables() {
+	if( tablesBuilt ) {
+		return;
+	}
+	for( int m = 0; m < 18; m++ ) {
+		cubieCube c;
+		c.move( m );
+		for( int i = 0; i < 8; i++ ) {
+			cornerFrom[m][i] = c.cp[i];
+			cornerTwist[m][i] = c.co[i];
+		}
+		for( int i = 0; i < 12; i++ ) {
+			edgeFrom[m][i] = c.ep[i];
+			edgeFlip[m][i] = c.eo[i];
+		}
+	}
+	for( int m = 0; m < 18; m++ ) {
+		for( int i = 0; i < NUM_TWIST; i++ ) {
+			cubieCube c;
+			c.setTwist( i );
+			c.move( m );
+			twistMove[i][m] = c.getTwist();
+		}
+		for( int i = 0; i < NUM_FLIP; i++ ) {
+			cubieCube c;
+			c.setFlip( i );
+			c.move( m );
+			flipMove[i][m] = c.getFlip();
+		}
+		for( int i = 0; i < NUM_SLICE; i++ ) {
+			cubieCube c;
+			c.setSlice( i );
+			c.move( m );
+			sliceMove[i][m] = c.getSlice();
+		}
+		for( int i = 0; i < NUM_CORNER_PERM; i++ ) {
+			cubieCube c;
+			c.setCornerPerm( i );
+			c.move( m );
+			cornerPermMove[i][m] = c.getCornerPerm();
+		}
+	}
+	sliceTwistDistance = buildDistance( twistMove, NUM_TWIST, "slice/twist" );
+	sliceFlipDistance = buildDistance( flipMove, NUM_FLIP, "slice/flip" );
+	tablesBuilt = true;
+}
+
+//Lower bound on the moves needed to solve a state
+static inline int lowerBound( int twist, int flip, int slice ) {
+	int a = getNibble( sliceTwistDistance, slice * NUM_TWIST + twist );
+	int b = getNibble( sliceFlipDistance, slice * NUM_FLIP + flip );
+	return a > b ? a : b;
+}
+
+static inline packedState applyMove( const packedState & s, int m ) {
+	packedState out;
+	out.corners = 0;
+	for( int i = 0; i < 8; i++ ) {
+		unsigned int f = ( s.corners >> ( 5 * cornerFrom[m][i] ) ) & 31;
+		unsigned int twist = ( f >> 3 ) + cornerTwist[m][i];
+		if( twist >= 3 ) {
+			twist -= 3;
+		}
+		out.corners |= (unsigned long long)( ( f & 7 ) | ( twist << 3 ) ) << ( 5 * i );
+	}
+	out.edges = 0;
+	for( int i = 0; i < 12; i++ ) {
+		unsigned int f = ( s.edges >> ( 5 * edgeFrom[m][i] ) ) & 31;
+		out.edges |= (unsigned long long)( f ^ ( edgeFlip[m][i] << 4 ) ) << ( 5 * i );
+	}
+	return out;
+}
+
+static inline int inverseMove( int m ) {
+	return m - m % 3 + 2 - m % 3;
+}
+
+/*
+ * Open-addressed hash set of packed states with linear probing.  The
+ * capacity is fixed at twice the state limit, so probes stay short and
+ * memory never grows.
+ */
+class bidirectionalSolver::stateSet {
+public:
+	stateSet( int limit ) : limit( limit ), count( 0 ) {
+		capacity = 1;
+		while( capacity < 2 * (size_t)limit ) {
+			capacity <<= 1;
+		}
+		entries = new packedState[capacity];
+		clear();
+	}
+
+	~stateSet() {
+		delete [] entries;
+	}
+
+	void clear() {
+		memset( entries, 0, capacity * sizeof( packedState ) );
+		count = 0;
+	}
+
+	/*
+	 * Adds a state with the move that reached it.  Returns 1 if added,
+	 * 0 if already present and -1 if the set is full.
+	 */
+	int insert( const packedState & s, int move ) {
+		size_t i = slot( s );
+		while( entries[i].corners & OCCUPIED ) {
+			if( ( entries[i].corners & STATE_MASK ) == s.corners && entries[i].edges == s.edges ) {
+				return 0;
+			}
+			i = ( i + 1 ) & ( capacity - 1 );
+		}
+		if( count >= limit ) {
+			return -1;
+		}
+		entries[i].corners = s.corners | ( (unsigned long long)move << MOVE_SHIFT ) | OCCUPIED;
+		entries[i].edges = s.edges;
+		count++;
+		return 1;
+	}
+
+	/*
+	 * Move that reached a state, or -1 if the state is not in the set.
+	 */
+	int find( const packedState & s ) const {
+		size_t i = slot( s );
+		while( entries[i].corners & OCCUPIED ) {
+			if( ( entries[i].corners & STATE_MASK ) == s.corners && entries[i].edges == s.edges ) {
+				return ( entries[i].corners >> MOVE_SHIFT ) & 31;
+			}
+			i = ( i + 1 ) & ( capacity - 1 );
+		}
+		return -1;
+	}
+
+	size_t getMemory() const { return capacity * sizeof( packedState ); }
+
+private:
+	packedState * entries;
+	size_t capacity;
+	int limit;
+	int count;
+
+	size_t slot( const packedState & s ) const {
+		unsigned long long h = s.corners * 0x9E3779B97F4A7C15ULL ^ s.edges * 0xC2B2AE3D27D4EB4FULL;
+		return (size_t)( h ^ ( h >> 29 ) ) & ( capacity - 1 );
+	}
+};
+
+/*
+ * Exact distance of the corners (permutation * NUM_TWIST + twist) up to
+ * a limit, in an open-addressed table of index + 1 | distance << 28.
+ * Only 1.4 million of the 88 million corner states are within 6 moves,
+ * so the table stays small.
+ */
+class bidirectionalSolver::cornerTable {
+public:
+	cornerTable( int limit ) : limit( limit ) {
+		capacity = 1;
+		while( capacity < 2 * (size_t)cornerBallSize[limit] ) {
+			capacity <<= 1;
+		}
+		entries = new unsigned int[capacity];
+		memset( entries, 0, capacity * sizeof( unsigned int ) );
+
+		//Breadth first over the corner coordinates
+		std::vector<unsigned int> layer, grown;
+		layer.push_back( 0 );
+		insert( 0, 0 );
+		for( int depth = 1; depth <= limit; depth++ ) {
+			grown.clear();
+			for( size_t k = 0; k < layer.size(); k++ ) {
+				int perm = layer[k] / NUM_TWIST, twist = layer[k] % NUM_TWIST;
+				for( int m = 0; m < 18; m++ ) {
+					unsigned int child = cornerPermMove[perm][m] * NUM_TWIST + twistMove[twist][m];
+					if( insert( child, depth ) ) {
+						grown.push_back( child );
+					}
+				}
+			}
+			layer.swap( grown );
+		}
+	}
+
+	~cornerTable() {
+		delete [] entries;
+	}
+
+	/*
+	 * Distance of a corner state, or limit + 1 if it is further.
+	 */
+	int distance( unsigned int index ) const {
+		size_t i = slot( index );
+		while( entries[i] ) {
+			if( ( entries[i] & KEY_MASK ) == index + 1 ) {
+				return entries[i] >> 28;
+			}
+			i = ( i + 1 ) & ( capacity - 1 );
+		}
+		return limit + 1;
+	}
+
+	size_t getMemory() const { return capacity * sizeof( unsigned int ); }
+
+private:
+	static const unsigned int KEY_MASK = ( 1U << 28 ) - 1;
+
+	unsigned int * entries;
+	size_t capacity;
+	int limit;
+
+	size_t slot( unsigned int index ) const {
+		return (size_t)( ( index * 0x9E3779B1U ) >> 7 ) & ( capacity - 1 );
+	}
+
+	//Returns false if the state was already reached
+	bool insert( unsigned int index, int depth ) {
+		size_t i = slot( index );
+		while( entries[i] ) {
+			if( ( entries[i] & KEY_MASK ) == index + 1 ) {
+				return false;
+			}
+			i = ( i + 1 ) & ( capacity - 1 );
+		}
+		entries[i] = ( index + 1 ) | ( (unsigned int)depth << 28 );
+		return true;
+	}
+};
+
+bidirectionalSolver::bidirectionalSolver( int backwardDepth, int forwardStates ) {
+	if( backwardDepth < 0 ) {
+		backwardDepth = 0;
+	}
+	if( backwardDepth > 6 ) {
+		backwardDepth = 6;
+	}
+	this->backwardDepth = backwardDepth;
+	backward = NULL;
+	corners = NULL;
+	forward = new stateSet( forwardStates );
+}
+
+bidirectionalSolver::~bidirectionalSolver() {
+	delete backward;
+	delete corners;
+	delete forward;
+}
+
+packedState bidirectionalSolver::pack( const cubieCube & cube ) {
+	packedState s;
+	s.corners = 0;
+	for( int i = 0; i < 8; i++ ) {
+		s.corners |= (unsigned long long)( cube.cp[i] | ( cube.co[i] << 3 ) ) << ( 5 * i );
+	}
+	s.edges = 0;
+	for( int i = 0; i < 12; i++ ) {
+		s.edges |= (unsigned long long)( cube.ep[i] | ( cube.eo[i] << 4 ) ) << ( 5 * i );
+	}
+	return s;
+}
+
+//Parity of a permutation of n pieces, 0 even, 1 odd
+static int parity( const unsigned char * perm, int n ) {
+	int inversions = 0;
+	for( int i = 0; i < n; i++ ) {
+		for( int j = i + 1; j < n; j++ ) {
+			inversions += perm[i] > perm[j];
+		}
+	}
+	return inversions & 1;
+}
+
+bool bidirectionalSolver::unpack( const packedState & s, cubieCube & cube ) {
+	int seen = 0, twist = 0, flip = 0;
+	for( int i = 0; i < 8; i++ ) {
+		int bits = (int)( s.corners >> ( 5 * i ) ) & 31;
+		cube.cp[i] = bits & 7;
+		cube.co[i] = bits >> 3;
+		seen |= 1 << cube.cp[i];
+		twist += cube.co[i];
+	}
+	if( seen != 0xff || ( s.corners & ~STATE_MASK ) ) {
+		return false;
+	}
+	seen = 0;
+	for( int i = 0; i < 12; i++ ) {
+		int bits = (int)( s.edges >> ( 5 * i ) ) & 31;
+		cube.ep[i] = bits & 15;
+		cube.eo[i] = bits >> 4;
+		if( cube.ep[i] < 12 ) {
+			seen |= 1 << cube.ep[i];
+		}
+		flip += cube.eo[i];
+	}
+	if( seen != 0xfff || ( s.edges >> 60 ) ) {
+		return false;
+	}
+	for( int i = 0; i < 8; i++ ) {
+		if( cube.co[i] > 2 ) {
+			return false;
+		}
+	}
+	return twist % 3 == 0 && flip % 2 == 0 && parity( cube.cp, 8 ) == parity( cube.ep, 12 );
+}
+
+void bidirectionalSolver::warm() {
+	if( backward ) {
+		return;
+	}
+	buildTables();
+	backward = new stateSet( ballSize[backwardDepth] );
+	corners = new cornerTable( CORNER_LIMIT );
+
+	//Breadth first from solved.  A move on the face just turned never
+	//reaches a new state, so it is skipped.
+	std::vector<packedState> layer, grown;
+	layer.push_back( pack( cubieCube() ) );
+	backward->insert( layer[0], NO_MOVE );
+	for( int depth = 0; depth < backwardDepth; depth++ ) {
+		grown.clear();
+		for( size_t k = 0; k < layer.size(); k++ ) {
+			int last = backward->find( layer[k] );
+			for( int m = 0; m < 18; m++ ) {
+				if( last != NO_MOVE && m / 3 == last / 3 ) {
+					continue;
+				}
+				packedState child = applyMove( layer[k], m );
+				if( backward->insert( child, m ) > 0 ) {
+					grown.push_back( child );
+				}
+			}
+		}
+		layer.swap( grown );
+	}
+}
+
+int bidirectionalSolver::solve( const cubieCube & cube, unsigned char * out, int maxLength ) {
+	warm();
+	packedState start = pack( cube );
+	packedState meet = start;
+	int length = 0;
+
+	if( backward->find( start ) < 0 ) {
+		//Forward layers until one reaches the backward set.  The first layer
+		//to do so only meets it at its outermost depth, so the first state
+		//found gives a shortest solution.
+		node first = { start, (unsigned short)cube.getTwist(), (unsigned short)cube.getFlip(), (unsigned short)cube.getSlice(),
+			(unsigned short)cube.getCornerPerm() };
+		if( lowerBound( first.twist, first.flip, first.slice ) > maxLength ) {
+			return -1;
+		}
+		forward->clear();
+		forward->insert( start, NO_MOVE );
+		frontier.clear();
+		frontier.push_back( first );
+		bool found = false;
+		for( int depth = 1; !found && depth + backwardDepth <= maxLength; depth++ ) {
+			//States of this layer are only kept if a later layer can still
+			//meet within maxLength
+			int keepBound = maxLength - depth;
+			bool keep = depth + 1 + backwardDepth <= maxLength;
+			next.clear();
+			for( size_t k = 0; k < frontier.size() && !found; k++ ) {
+				const node & parent = frontier[k];
+				int last = forward->find( parent.state );
+				for( int m = 0; m < 18; m++ ) {
+					if( last != NO_MOVE && m / 3 == last / 3 ) {
+						continue;
+					}
+					node child;
+					child.twist = twistMove[parent.twist][m];
+					child.flip = flipMove[parent.flip][m];
+					child.slice = sliceMove[parent.slice][m];
+					int bound = lowerBound( child.twist, child.flip, child.slice );
+					if( bound > keepBound ) {
+						continue;
+					}
+					child.perm = cornerPermMove[parent.perm][m];
+					//The corners alone are exact near the backward set, where
+					//the phase 1 bound is weakest.  Further out they can not
+					//prune, so the table is not read.
+					if( keepBound <= CORNER_LIMIT || bound <= backwardDepth ) {
+						int cornerBound = corners->distance( child.perm * NUM_TWIST + child.twist );
+						if( cornerBound > bound ) {
+							bound = cornerBound;
+							if( bound > keepBound ) {
+								continue;
+							}
+						}
+					}
+					child.state = applyMove( parent.state, m );
+					if( bound <= backwardDepth && backward->find( child.state ) >= 0 ) {
+						//Forward half: walk back to the start, then reverse
+						for( packedState s = parent.state; ( last = forward->find( s ) ) != NO_MOVE; ) {
+							out[length++] = (unsigned char)last;
+							s = applyMove( s, inverseMove( last ) );
+						}
+						std::reverse( out, out + length );
+						out[length++] = (unsigned char)m;
+						meet = child.state;
+						found = true;
+						break;
+					}
+					if( keep ) {
+						int added = forward->insert( child.state, m );
+						if( added < 0 ) {
+							return -1;
+						}
+						if( added ) {
+							next.push_back( child );
+						}
+					}
+				}
+			}
+			frontier.swap( next );
+		}
+		if( !found ) {
+			return -1;
+		}
+	}
+
+	//Backward half: undo the moves that built the meeting state
+	for( int move; ( move = backward->find( meet ) ) != NO_MOVE; ) {
+		out[length++] = (unsigned char)inverseMove( move );
+		meet = applyMove( meet, inverseMove( move ) );
+	}
+	return length <= maxLength ? length : -1;
+}
+
+int bidirectionalSolver::solve( const cubeModel & state, cubeModel::move * out, int maxLength ) {
+	cubieCube cube;
+	if( !cube.fromModel( state ) ) {
+		return -1;
+	}
+	unsigned char moves[32];
+	int length = solve( cube, moves, maxLength < 32 ? maxLength : 32 );
+	for( int i = 0; i < length; i++ ) {
+		out[i] = cubieCube::toMove( moves[i] );
+	}
+	return length;
+}
+
+size_t bidirectionalSolver::getMemory() const {
+	return ( backward ? backward->getMemory() + corners->getMemory() : 0 ) + forward->getMemory();
+}
+
+void bidirectionalSolver::benchmark( int count, int scrambleLength, unsigned int seed ) {
+	std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+	warm();
+	double warmMillis = std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - begin ).count();
+	printf( "Backward set: depth %d, %.0f ms, %.1f MB in total\n", backwardDepth, warmMillis, getMemory() / 1048576.0 );
+
+	int solved[32] = { 0 };
+	double total[32] = { 0 }, worst[32] = { 0 };
+	int failed = 0;
+	unsigned char moves[32];
+	for( int i = 0; i < count; i++ ) {
+		cubieCube cube;
+		int previous = -1;
+		for( int k = 0; k < scrambleLength; k++ ) {
+			int m;
+			do {
+				seed = seed * 1103515245 + 12345;
+				m = ( seed >> 16 ) % 18;
+			} while( previous >= 0 && m / 3 == previous / 3 );
+			cube.move( m );
+			previous = m;
+		}
+		begin = std::chrono::high_resolution_clock::now();
+		int length = solve( cube, moves, scrambleLength < 31 ? scrambleLength : 31 );
+		double millis = std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - begin ).count();
+		if( length < 0 ) {
+			failed++;
+			continue;
+		}
+		solved[length]++;
+		total[length] += millis;
+		worst[length] = std::max( worst[length], millis );
+	}
+	printf( "Moves  states  average ms  worst ms\n" );
+	for( int d = 0; d < 32; d++ ) {
+		if( solved[d] ) {
+			printf( "%5d %7d %11.3f %9.3f\n", d, solved[d], total[d] / solved[d], worst[d] );
+		}
+	}
+	if( failed ) {
+		printf( "Not solved (forward set full): %d\n", failed );
+	}
+}
@@ -0,0 +1,118 @@
+//Header file for Rubiks cube project
+#ifndef BIDIRECTIONAL_H
+#define BIDIRECTIONAL_H
+#include "cubieCube.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * Meet-in-the-middle solver for 3x3 states a few moves from solved, such
+ * as a user's last mistakes.  Finds shortest solutions without the
+ * pattern databases of optimalSolver.
+ *
+ * States are packed into two 64-bit words (piece and orientation of each
+ * corner and edge slot) and kept in open-addressed hash sets of fixed
+ * capacity, so memory use is set when the solver is created:
+ *	- the backward set holds every state within backwardDepth moves of
+ *	  solved.  It is the same for every query, so it is built once on
+ *	  first use and kept.
+ *	- the forward set holds the layers of a breadth-first search from
+ *	  the query state and is cleared between queries.
+ * The forward search stops at the first layer that reaches the backward
+ * set, which gives an optimal solution.
+ *
+ * Forward states are only kept, and only looked up in the backward set,
+ * if a lower bound on their distance allows a solution within the
+ * requested length.  The bound is the larger of the two-phase solver's
+ * phase 1 distance (twist/flip and the middle slice edges, from two small
+ * tables) and the exact distance of the corners, known up to 6 moves.
+ * The corners prune the states that are already oriented,
+ * which the phase 1 bound lets through, both in the last layer, where
+ * nearly all the time goes, and in the layer before it.
+ */
+class bidirectionalSolver {
+public:
+	/*
+	 * Constructor.  backwardDepth 5 keeps 621,649 states (32 MB) and
+	 * solves depth 10 with a forward search of depth 5.  The corner
+	 * distances take another 16 MB.  forwardStates is
+	 * the most forward states kept per query.
+	 */
+	bidirectionalSolver( int backwardDepth = 5, int forwardStates = 1 << 16 );
+
+	/*
+	 * Destructor
+	 */
+	~bidirectionalSolver();
+
+	/*
+	 * Finds a shortest solution of at most maxLength moves.  Moves are
+	 * written to out (cubieCube move numbers).  Returns the number of
+	 * moves, or -1 if the state is further away or the forward set filled
+	 * up first.
+	 */
+	int solve( const cubieCube & cube, unsigned char * out, int maxLength = 10 );
+
+	/*
+	 * Solves a 3x3 sticker state.  Writes packed moves to out.
+	 */
+	int solve( const cubeModel & state, cubeModel::move * out, int maxLength = 10 );
+
+	/*
+	 * Solves count states scrambled with scrambleLength random moves and
+	 * prints the latency of each solution length to stdout.
+	 */
+	void benchmark( int count, int scrambleLength, unsigned int seed );
+
+	/*
+	 * Bytes used by both hash sets.
+	 */
+	size_t getMemory() const;
+
+	/*
+	 * Packed state: each corner slot holds piece | twist << 3 in 5 bits,
+	 * each edge slot piece | flip << 4 in 5 bits.
+	 */
+	struct packedState {
+		unsigned long long corners;
+		unsigned long long edges;
+	};
+
+	static packedState pack( const cubieCube & cube );
+
+	/*
+	 * Reads a packed state back.  Returns false if it is not a solvable
+	 * cube (a piece missing or repeated, a bad total twist or flip, or
+	 * corner and edge permutations of different parity).
+	 */
+	static bool unpack( const packedState & s, cubieCube & cube );
+
+private:
+	class stateSet;
+	class cornerTable;
+
+	/*
+	 * Forward search state with its phase 1 coordinates and corner
+	 * permutation for the bounds.
+	 */
+	struct node {
+		packedState state;
+		unsigned short twist, flip, slice, perm;
+	};
+
+	int backwardDepth;
+	stateSet * backward;
+	cornerTable * corners;	//Corner distances up to 6 moves
+	stateSet * forward;
+	std::vector<node> frontier, next;	//Forward layers being expanded
+
+	/*
+	 * Fills the backward set on first use.
+	 */
+	void warm();
+
+	//Not copyable
+	bidirectionalSolver( const bidirectionalSolver & );
+	bidirectionalSolver & operator=( const bidirectionalSolver & );
+};
+#endif
@@ -0,0 +1,236 @@
+#include "cosets.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+//Shard and merged file header
+struct cosetHeader {
+	char magic[8];
+	unsigned int version;
+	int shard;
+	int numShards;
+	int reserved;
+	long long first;	//First coset in the file
+	long long count;	//Cosets in the file
+};
+static const char fileMagic[8] = { 'R', 'K', 'C', 'O', 'S', 'E', 'T', 'S' };
+static const unsigned int fileVersion = 1;
+
+cosetSearch::cosetSearch( const kociembaSolver & solver ) : solver( solver ) {
+}
+
+void cosetSearch::shardRange( int shard, int numShards, long long first, long long count,
+	long long & shardFirst, long long & shardCount ) {
+	shardFirst = first + count * shard / numShards;
+	shardCount = first + count * ( shard + 1 ) / numShards - shardFirst;
+}
+
+bool cosetSearch::runShard( int shard, int numShards, long long first, long long count, const char * path ) {
+	long long begin, size;
+	shardRange( shard, numShards, first, count, begin, size );
+
+	//Written under a temporary name so an unfinished shard is never merged
+	std::string partial = std::string( path ) + ".part";
+	FILE * out = fopen( partial.c_str(), "wb" );
+	if( !out ) {
+		fprintf( stderr, "Could not create %s\n", partial.c_str() );
+		return false;
+	}
+	cosetHeader header;
+	memset( &header, 0, sizeof( header ) );
+	memcpy( header.magic, fileMagic, 8 );
+	header.version = fileVersion;
+	header.shard = shard;
+	header.numShards = numShards;
+	header.first = begin;
+	header.count = size;
+	bool ok = fwrite( &header, sizeof( header ), 1, out ) == 1;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	const int blockSize = 65536;
+	std::vector<unsigned char> block( blockSize );
+	for( long long done = 0; ok && done < size; ) {
+		int n = size - done < blockSize ? (int)( size - done ) : blockSize;
+		for( int i = 0; i < n; i++ ) {
+			long long coset = begin + done + i;
+			int flip = (int)( coset % kociembaSolver::NUM_FLIP );
+			long long rest = coset / kociembaSolver::NUM_FLIP;
+			int twist = (int)( rest % kociembaSolver::NUM_TWIST );
+			int slice = (int)( rest / kociembaSolver::NUM_TWIST );
+			block[i] = (unsigned char)solver.phase1Distance( twist, flip, slice );
+		}
+		ok = fwrite( &block[0], 1, n, out ) == (size_t)n;
+		done += n;
+
+		double seconds = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - start ).count();
+		fprintf( stderr, "Shard %d/%d: %lld of %lld cosets, %.0f cosets/s\n", shard + 1, numShards,
+			done, size, done / ( seconds > 0 ? seconds : 1 ) );
+	}
+	ok = fclose( out ) == 0 && ok;
+
+	remove( path );
+	if( !ok || rename( partial.c_str(), path ) != 0 ) {
+		fprintf( stderr, "Could not write %s\n", path );
+		return false;
+	}
+	return true;
+}
+
+#ifdef _WIN32
+typedef intptr_t workerHandle;
+
+static workerHandle startWorker( const char * const * args ) {
+	return _spawnv( _P_NOWAIT, args[0], args );
+}
+
+static bool waitWorker( workerHandle worker ) {
+	int status = -1;
+	return worker != -1 && _cwait( &status, worker, 0 ) != -1 && status == 0;
+}
+#else
+typedef pid_t workerHandle;
+
+static workerHandle startWorker( const char * const * args ) {
+	pid_t pid = fork();
+	if( pid == 0 ) {
+		execvp( args[0], (char * const *)args );
+		_exit( 127 );
+	}
+	return pid;
+}
+
+static bool waitWorker( workerHandle worker ) {
+	int status = -1;
+	return worker > 0 && waitpid( worker, &status, 0 ) == worker && WIFEXITED( status )
+		&& WEXITSTATUS( status ) == 0;
+}
+#endif
+
+bool cosetSearch::launch( const char * program, int numShards, long long first, long long count, const char * path ) {
+	std::vector<std::string> files( numShards );
+	std::vector<workerHandle> workers( numShards );
+	char numbers[4][32];
+	sprintf( numbers[1], "%d", numShards );
+	sprintf( numbers[2], "%lld", first );
+	sprintf( numbers[3], "%lld", count );
+	for( int i = 0; i < numShards; i++ ) {
+		files[i] = std::string( path ) + "." + std::to_string( (long long)i );
+		sprintf( numbers[0], "%d", i );
+		const char * args[] = { program, "-coset-shard", numbers[0], numbers[1], numbers[2], numbers[3],
+			files[i].c_str(), NULL };
+		workers[i] = startWorker( args );
+	}
+	bool ok = true;
+	for( int i = 0; i < numShards; i++ ) {
+		if( !waitWorker( workers[i] ) ) {
+			fprintf( stderr, "Shard %d failed\n", i + 1 );
+			ok = false;
+		}
+	}
+	if( !ok ) {
+		return false;
+	}
+	std::vector<const char *> names( numShards );
+	for( int i = 0; i < numShards; i++ ) {
+		names[i] = files[i].c_str();
+	}
+	if( !merge( path, &names[0], numShards ) ) {
+		return false;
+	}
+	for( int i = 0; i < numShards; i++ ) {
+		remove( names[i] );
+	}
+	return true;
+}
+
+bool cosetSearch::merge( const char * path, const char * const * shards, int numShards ) {
+	//Read the headers and order the shards by their first coset
+	std::vector<cosetHeader> headers( numShards );
+	std::vector<int> order( numShards );
+	for( int i = 0; i < numShards; i++ ) {
+		FILE * in = fopen( shards[i], "rb" );
+		bool ok = in && fread( &headers[i], sizeof( cosetHeader ), 1, in ) == 1
+			&& memcmp( headers[i].magic, fileMagic, 8 ) == 0 && headers[i].version == fileVersion;
+		if( in ) {
+			fclose( in );
+		}
+		if( !ok ) {
+			fprintf( stderr, "%s is not a coset file\n", shards[i] );
+			return false;
+		}
+		order[i] = i;
+		for( int j = i; j > 0 && headers[order[j]].first < headers[order[j - 1]].first; j-- ) {
+			std::swap( order[j], order[j - 1] );
+		}
+	}
+	for( int i = 1; i < numShards; i++ ) {
+		const cosetHeader & last = headers[order[i - 1]];
+		if( last.first + last.count != headers[order[i]].first ) {
+			fprintf( stderr, "%s does not follow %s\n", shards[order[i]], shards[order[i - 1]] );
+			return false;
+		}
+	}
+
+	std::string partial = std::string( path ) + ".part";
+	FILE * out = fopen( partial.c_str(), "wb" );
+	if( !out ) {
+		fprintf( stderr, "Could not create %s\n", partial.c_str() );
+		return false;
+	}
+	cosetHeader header = headers[order[0]];
+	header.shard = 0;
+	header.numShards = 1;
+	header.count = 0;
+	for( int i = 0; i < numShards; i++ ) {
+		header.count += headers[i].count;
+	}
+	bool ok = fwrite( &header, sizeof( header ), 1, out ) == 1;
+
+	//Copy the distances and count them
+	long long distances[256] = { 0 };
+	std::vector<unsigned char> block( 1 << 20 );
+	for( int i = 0; ok && i < numShards; i++ ) {
+		FILE * in = fopen( shards[order[i]], "rb" );
+		long long left = headers[order[i]].count;
+		ok = in && fseek( in, sizeof( cosetHeader ), SEEK_SET ) == 0;
+		while( ok && left > 0 ) {
+			size_t n = left < (long long)block.size() ? (size_t)left : block.size();
+			ok = fread( &block[0], 1, n, in ) == n && fwrite( &block[0], 1, n, out ) == n;
+			for( size_t k = 0; k < n; k++ ) {
+				distances[block[k]]++;
+			}
+			left -= n;
+		}
+		if( in ) {
+			fclose( in );
+		}
+		if( !ok ) {
+			fprintf( stderr, "Could not copy %s\n", shards[order[i]] );
+		}
+	}
+	ok = fclose( out ) == 0 && ok;
+	remove( path );
+	if( !ok || rename( partial.c_str(), path ) != 0 ) {
+		fprintf( stderr, "Could not write %s\n", path );
+		return false;
+	}
+
+	printf( "Cosets %lld to %lld from %d shards\n", header.first, header.first + header.count - 1, numShards );
+	for( int d = 0; d < 256; d++ ) {
+		if( distances[d] ) {
+			printf( "%5d moves: %lld\n", d, distances[d] );
+		}
+	}
+	return true;
+}
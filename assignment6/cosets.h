@@ -0,0 +1,67 @@
+//Header file for Rubiks cube project
+#ifndef COSETS_H
+#define COSETS_H
+#include "kociemba.h"
+
+/*
+ * Sharded enumeration of the cosets of H = <U, D, R2, L2, F2, B2>.
+ *
+ * Each of the 2,217,093,120 cosets is given by its phase 1 coordinates,
+ * numbered (slice * NUM_TWIST + twist) * NUM_FLIP + flip.  The search
+ * finds the exact distance of every coset in a range, one byte each.
+ *
+ * A range is split into contiguous shards, one per worker process.  The
+ * workers map the same two-phase table file, so the tables are in memory
+ * once however many run, and each writes its own shard file.  merge()
+ * joins shard files back into one file for the whole range, checking
+ * that they fit together, and prints the distribution of distances.
+ * Shards can be run on other hosts and their files merged afterwards.
+ *
+ * Shard and merged files have the same layout: a cosetHeader, then one
+ * distance byte per coset of the shard.
+ */
+class cosetSearch {
+public:
+	/*
+	 * Constructor.  The solver must be loaded.
+	 */
+	cosetSearch( const kociembaSolver & solver );
+
+	/*
+	 * Searches shard number shard of numShards of the range
+	 * [first, first + count) and writes it to path.  Returns false if
+	 * the file could not be written.
+	 */
+	bool runShard( int shard, int numShards, long long first, long long count, const char * path );
+
+	/*
+	 * Runs numShards worker processes of program (this program) with
+	 * "-coset-shard", waits for them and merges their files into path.
+	 * Shard files are named path.0, path.1, ...  Returns false if a
+	 * worker failed.
+	 */
+	static bool launch( const char * program, int numShards, long long first, long long count, const char * path );
+
+	/*
+	 * Merges shard files into one file at path.  Returns false if they
+	 * can not be read or do not form one contiguous range.
+	 */
+	static bool merge( const char * path, const char * const * shards, int numShards );
+
+	/*
+	 * First coset and count of a shard of a range.
+	 */
+	static void shardRange( int shard, int numShards, long long first, long long count,
+		long long & shardFirst, long long & shardCount );
+
+	static const long long NUM_COSETS = (long long)kociembaSolver::NUM_SLICE * kociembaSolver::NUM_TWIST
+		* kociembaSolver::NUM_FLIP;
+
+private:
+	const kociembaSolver & solver;
+
+	//Not copyable
+	cosetSearch( const cosetSearch & );
+	cosetSearch & operator=( const cosetSearch & );
+};
+#endif
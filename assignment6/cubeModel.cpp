@@ -0,0 +1,330 @@
+#include "cubeModel.h"
+#include <cstring>
+
+const int cubeModel::cornerSlots[8][3][3] = {
+	{ { TOP, 2, 2 }, { RIGHT, 0, 0 }, { FRONT, 0, 2 } },	//URF
+	{ { TOP, 2, 0 }, { FRONT, 0, 0 }, { LEFT, 0, 2 } },		//UFL
+	{ { TOP, 0, 0 }, { LEFT, 0, 0 }, { BACK, 0, 2 } },		//ULB
+	{ { TOP, 0, 2 }, { BACK, 0, 0 }, { RIGHT, 0, 2 } },		//UBR
+	{ { BOTTOM, 0, 2 }, { FRONT, 2, 2 }, { RIGHT, 2, 0 } },	//DFR
+	{ { BOTTOM, 0, 0 }, { LEFT, 2, 2 }, { FRONT, 2, 0 } },	//DLF
+	{ { BOTTOM, 2, 0 }, { BACK, 2, 2 }, { LEFT, 2, 0 } },	//DBL
+	{ { BOTTOM, 2, 2 }, { RIGHT, 2, 2 }, { BACK, 2, 0 } }	//DRB
+};
+
+const int cubeModel::edgeSlots[12][2][3] = {
+	{ { TOP, 1, 2 }, { RIGHT, 0, 1 } },		//UR
+	{ { TOP, 2, 1 }, { FRONT, 0, 1 } },		//UF
+	{ { TOP, 1, 0 }, { LEFT, 0, 1 } },		//UL
+	{ { TOP, 0, 1 }, { BACK, 0, 1 } },		//UB
+	{ { BOTTOM, 1, 2 }, { RIGHT, 2, 1 } },	//DR
+	{ { BOTTOM, 0, 1 }, { FRONT, 2, 1 } },	//DF
+	{ { BOTTOM, 1, 0 }, { LEFT, 2, 1 } },	//DL
+	{ { BOTTOM, 2, 1 }, { BACK, 2, 1 } },	//DB
+	{ { FRONT, 1, 2 }, { RIGHT, 1, 0 } },	//FR
+	{ { FRONT, 1, 0 }, { LEFT, 1, 2 } },	//FL
+	{ { BACK, 1, 2 }, { LEFT, 1, 0 } },		//BL
+	{ { BACK, 1, 0 }, { RIGHT, 1, 2 } }		//BR
+};
+
+//Faces visited by a +90 degree turn about each axis
+static const int turnCycle[3][4] = {
+	{ cubeModel::FRONT, cubeModel::BOTTOM, cubeModel::BACK, cubeModel::TOP },	//x
+	{ cubeModel::FRONT, cubeModel::RIGHT, cubeModel::BACK, cubeModel::LEFT },	//y
+	{ cubeModel::TOP, cubeModel::LEFT, cubeModel::BOTTOM, cubeModel::RIGHT }	//z
+};
+
+//Face on the positive side of each axis
+static const int positiveFace[3] = { cubeModel::RIGHT, cubeModel::TOP, cubeModel::FRONT };
+
+cubeModel::cubeModel( int dimensions ) {
+	dim = dimensions;
+	allocate();
+	reset();
+}
+
+cubeModel::cubeModel( const cubeModel & other ) {
+	dim = other.dim;
+	allocate();
+	memcpy( stickers, other.stickers, getNumStickers() );
+}
+
+cubeModel & cubeModel::operator=( const cubeModel & other ) {
+	if( this != &other ) {
+		if( dim != other.dim ) {
+			delete [] stickers;
+			delete [] ring;
+			delete [] temp;
+			dim = other.dim;
+			allocate();
+		}
+		memcpy( stickers, other.stickers, getNumStickers() );
+	}
+	return *this;
+}
+
+cubeModel::~cubeModel() {
+	delete [] stickers;
+	delete [] ring;
+	delete [] temp;
+}
+
+void cubeModel::allocate() {
+	stickers = new unsigned char[getNumStickers()];
+	ring = new int[4 * dim];
+	temp = new unsigned char[dim * dim > 4 * dim ? dim * dim : 4 * dim];
+}
+
+void cubeModel::reset() {
+	for( int f = 0; f < 6; f++ ) {
+		memset( stickers + f * dim * dim, f, dim * dim );
+	}
+}
+
+bool cubeModel::isSolved() const {
+	for( int f = 0; f < 6; f++ ) {
+		const unsigned char * side = stickers + f * dim * dim;
+		for( int i = 1; i < dim * dim; i++ ) {
+			if( side[i] != side[0] ) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void cubeModel::buildRing( int axis, int layer, int * out ) const {
+	int n = dim - 1;
+	const int * cycle = turnCycle[axis];
+
+	//Strip on the first face of the cycle
+	for( int t = 0; t < dim; t++ ) {
+		switch( axis ) {
+			case 0:
+				out[t] = index( cycle[0], t, layer );
+				break;
+			case 1:
+				out[t] = index( cycle[0], n - layer, t );
+				break;
+			default:
+				out[t] = index( cycle[0], layer, t );
+				break;
+		}
+	}
+
+	//Each following strip is the previous one turned by 90 degrees
+	int a = ( axis + 1 ) % 3;
+	int b = ( axis + 2 ) % 3;
+	for( int q = 1; q < 4; q++ ) {
+		int face = cycle[q - 1];
+		for( int t = 0; t < dim; t++ ) {
+			int sticker = out[( q - 1 ) * dim + t] - face * dim * dim;
+			int p[3];
+			position( face, sticker / dim, sticker % dim, p[0], p[1], p[2] );
+			int swap = p[a];
+			p[a] = n - p[b];
+			p[b] = swap;
+			out[q * dim + t] = stickerAt( cycle[q], p[0], p[1], p[2] );
+		}
+	}
+}
+
+void cubeModel::rotateFace( int face, int quarters ) {
+	int n = dim - 1;
+	unsigned char * side = stickers + face * dim * dim;
+	memcpy( temp, side, dim * dim );
+	for( int i = 0; i < dim; i++ ) {
+		for( int j = 0; j < dim; j++ ) {
+			switch( quarters & 3 ) {
+				case 1:
+					side[( n - j ) * dim + i] = temp[i * dim + j];
+					break;
+				case 2:
+					side[( n - i ) * dim + n - j] = temp[i * dim + j];
+					break;
+				case 3:
+					side[j * dim + n - i] = temp[i * dim + j];
+					break;
+			}
+		}
+	}
+}
+
+void cubeModel::turn( int axis, int first, int last, int quarters ) {
+	quarters &= 3;
+	if( quarters == 0 ) {
+		return;
+	}
+	int size = 4 * dim;
+	int shift = quarters * dim;
+	for( int layer = first; layer <= last; layer++ ) {
+		buildRing( axis, layer, ring );
+		for( int p = 0; p < size; p++ ) {
+			temp[p] = stickers[ring[p]];
+		}
+		for( int p = 0; p < size; p++ ) {
+			int to = p + shift;
+			stickers[ring[to < size ? to : to - size]] = temp[p];
+		}
+	}
+
+	//Outer layers also turn a face.  The face on the positive side of the
+	//axis turns counterclockwise, the one on the negative side clockwise.
+	if( last == dim - 1 ) {
+		rotateFace( positiveFace[axis], quarters );
+	}
+	if( first == 0 ) {
+		rotateFace( positiveFace[axis] ^ 1, 4 - quarters );
+	}
+}
+
+void cubeModel::apply( move m ) {
+	int axis, first, last, quarters;
+	if( resolve( m, axis, first, last, quarters ) ) {
+		turn( axis, first, last, quarters );
+	}
+}
+
+bool cubeModel::resolve( move m, int & axis, int & first, int & last, int & quarters ) const {
+	int face = moveFace( m );
+	first = moveFirst( m );
+	last = moveLast( m );
+	if( last == ALL_LAYERS ) {
+		last = dim - 1;
+	}
+	else if( last == INNER_LAYERS ) {
+		last = dim - 2;
+	}
+	if( last > dim - 1 ) {
+		last = dim - 1;
+	}
+	if( first > last ) {
+		return false;
+	}
+
+	//Front, Top and Right lie on the positive side of their axis and turn
+	//clockwise with -90 degrees, the opposite faces with +90 degrees.
+	axis = 2 - ( face >> 1 );
+	quarters = moveQuarters( m );
+	if( !( face & 1 ) ) {
+		int temp = first;
+		first = dim - 1 - last;
+		last = dim - 1 - temp;
+		quarters = 4 - quarters;
+	}
+	return true;
+}
+
+void cubeModel::apply( const move * moves, int count ) {
+	for( int i = 0; i < count; i++ ) {
+		apply( moves[i] );
+	}
+}
+
+int cubeModel::moveSticker( int sticker, move m ) const {
+	int axis, first, last, quarters;
+	if( !resolve( m, axis, first, last, quarters ) ) {
+		return sticker;
+	}
+	int face = sticker / ( dim * dim );
+	int p[3], v[3];
+	position( face, sticker / dim % dim, sticker % dim, p[0], p[1], p[2] );
+	if( p[axis] < first || p[axis] > last ) {
+		return sticker;
+	}
+	normal( face, v[0], v[1], v[2] );
+
+	//Same rotation as one step around buildRing
+	int a = ( axis + 1 ) % 3;
+	int b = ( axis + 2 ) % 3;
+	for( int q = quarters & 3; q > 0; q-- ) {
+		int swap = p[a];
+		p[a] = dim - 1 - p[b];
+		p[b] = swap;
+		swap = v[a];
+		v[a] = -v[b];
+		v[b] = swap;
+	}
+	return stickerAt( faceFromNormal( v[0], v[1], v[2] ), p[0], p[1], p[2] );
+}
+
+int cubeModel::layerStickers( int axis, int layer, int * out ) const {
+	buildRing( axis, layer, out );
+	int count = 4 * dim;
+	for( int side = 0; side < 2; side++ ) {
+		if( layer == ( side ? 0 : dim - 1 ) ) {
+			int face = positiveFace[axis] ^ side;
+			for( int i = 0; i < dim * dim; i++ ) {
+				out[count++] = face * dim * dim + i;
+			}
+		}
+	}
+	return count;
+}
+
+void cubeModel::position( int face, int row, int col, int & x, int & y, int & z ) const {
+	int n = dim - 1;
+	switch( face ) {
+		case FRONT:
+			x = col;		y = n - row;	z = n;
+			break;
+		case BACK:
+			x = n - col;	y = n - row;	z = 0;
+			break;
+		case TOP:
+			x = col;		y = n;			z = row;
+			break;
+		case BOTTOM:
+			x = col;		y = 0;			z = n - row;
+			break;
+		case RIGHT:
+			x = n;			y = n - row;	z = n - col;
+			break;
+		default: //LEFT
+			x = 0;			y = n - row;	z = col;
+			break;
+	}
+}
+
+int cubeModel::stickerAt( int face, int x, int y, int z ) const {
+	int n = dim - 1;
+	switch( face ) {
+		case FRONT:
+			return index( face, n - y, x );
+		case BACK:
+			return index( face, n - y, n - x );
+		case TOP:
+			return index( face, z, x );
+		case BOTTOM:
+			return index( face, n - z, x );
+		case RIGHT:
+			return index( face, n - y, n - z );
+		default: //LEFT
+			return index( face, n - y, z );
+	}
+}
+
+int cubeModel::slotSticker( const int * slot ) const {
+	int scale[3] = { 0, dim / 2, dim - 1 };
+	return index( slot[0], scale[slot[1]], scale[slot[2]] );
+}
+
+void cubeModel::normal( int face, int & x, int & y, int & z ) {
+	int sign = ( face & 1 ) ? -1 : 1;
+	x = y = z = 0;
+	switch( face >> 1 ) {
+		case 0:	z = sign; break;	//Front/Back
+		case 1:	y = sign; break;	//Top/Bottom
+		default: x = sign; break;	//Right/Left
+	}
+}
+
+int cubeModel::faceFromNormal( int x, int y, int z ) {
+	if( z ) {
+		return z > 0 ? FRONT : BACK;
+	}
+	if( y ) {
+		return y > 0 ? TOP : BOTTOM;
+	}
+	return x > 0 ? RIGHT : LEFT;
+}
@@ -0,0 +1,195 @@
+//Header file for Rubiks cube project
+#ifndef CUBEMODEL_H
+#define CUBEMODEL_H
+
+/*
+ * Sticker level state of an NxN cube with no OpenGL dependencies.
+ *
+ * Stickers are stored as color indices, one byte each, face after face
+ * in the same order as rubiksCube's color scheme:
+ * 0: Front  1: Back  2: Top  3: Bottom  4: Right  5: Left
+ * Opposite faces only differ in the lowest bit (face ^ 1).
+ *
+ * Each face is dim*dim stickers in row major order, laid out as
+ * rubiksCube::drawFace draws them: viewed from outside the cube, row 0
+ * on top.  Top has the back edge in row 0, Bottom has the front edge in
+ * row 0 and the four side faces have Top above row 0.
+ *
+ * Positions are given in cell coordinates (x right, y up, z towards the
+ * viewer), each in [0, dim).
+ *
+ * Turns are applied to the sticker array directly.  A layer turn touches
+ * the 4*dim stickers around the layer plus a full face for outer layers.
+ */
+class cubeModel {
+public:
+	enum { FRONT = 0, BACK, TOP, BOTTOM, RIGHT, LEFT };
+
+	/*
+	 * Packed move code:
+	 * bits 0-2:	face the move is named after
+	 * bits 3-4:	quarter turns clockwise looking at that face (1-3)
+	 * bits 5-17:	first layer, counted from the face (0 = outer layer)
+	 * bits 18-30:	last layer, counted from the face
+	 * A last layer of ALL_LAYERS means dim-1 (cube rotation) and
+	 * INNER_LAYERS means dim-2 (M/E/S slices), resolved when applied.
+	 */
+	typedef unsigned int move;
+	enum { ALL_LAYERS = 0x1FFF, INNER_LAYERS = 0x1FFE };
+
+	static move makeMove( int face, int quarters, int first, int last ) {
+		return face | ( ( quarters & 3 ) << 3 ) | ( first << 5 ) | ( last << 18 );
+	}
+	static int moveFace( move m ) { return m & 7; }
+	static int moveQuarters( move m ) { return ( m >> 3 ) & 3; }
+	static int moveFirst( move m ) { return ( m >> 5 ) & 0x1FFF; }
+	static int moveLast( move m ) { return ( m >> 18 ) & 0x1FFF; }
+	static move inverse( move m ) {
+		return makeMove( moveFace( m ), 4 - moveQuarters( m ), moveFirst( m ), moveLast( m ) );
+	}
+
+	/*
+	 * Sticker coordinates (face, row, column) on a 3x3 grid for the
+	 * 8 corner and 12 edge slots:
+	 * URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB
+	 * UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR
+	 * Corner stickers are listed clockwise starting with the Top/Bottom
+	 * sticker.  Edge stickers start with the Top/Bottom sticker, or the
+	 * Front/Back sticker for the four middle layer edges.
+	 * Row/column 1 scales to dim/2 and 2 scales to dim-1 for larger cubes.
+	 */
+	static const int cornerSlots[8][3][3];
+	static const int edgeSlots[12][2][3];
+
+	/*
+	 * Creates a solved cube
+	 */
+	cubeModel( int dimensions );
+
+	cubeModel( const cubeModel & other );
+	cubeModel & operator=( const cubeModel & other );
+
+	/*
+	 * Destructor
+	 */
+	~cubeModel();
+
+	/*
+	 * Returns number of blocks in a row/column.
+	 */
+	int getDimensions() const { return dim; }
+
+	/*
+	 * Returns total number of stickers (6 * dim * dim).
+	 */
+	int getNumStickers() const { return 6 * dim * dim; }
+
+	/*
+	 * Raw sticker array, getNumStickers() entries.
+	 */
+	unsigned char * getStickers() { return stickers; }
+	const unsigned char * getStickers() const { return stickers; }
+
+	/*
+	 * Index into the sticker array for a sticker on a face.
+	 */
+	int index( int face, int row, int col ) const {
+		return ( face * dim + row ) * dim + col;
+	}
+
+	unsigned char get( int face, int row, int col ) const {
+		return stickers[index( face, row, col )];
+	}
+	void set( int face, int row, int col, unsigned char color ) {
+		stickers[index( face, row, col )] = color;
+	}
+
+	/*
+	 * Restores the solved state.
+	 */
+	void reset();
+
+	/*
+	 * Returns whether every face shows a single color.
+	 */
+	bool isSolved() const;
+
+	/*
+	 * Turns layers first..last (cell coordinate along axis, 0 = x, 1 = y,
+	 * 2 = z) counterclockwise looking down the positive axis, by the given
+	 * number of quarter turns.
+	 */
+	void turn( int axis, int first, int last, int quarters );
+
+	/*
+	 * Applies a packed move or a batch of packed moves.
+	 */
+	void apply( move m );
+	void apply( const move * moves, int count );
+
+	/*
+	 * Converts a packed move into turn() arguments for this cube's
+	 * dimensions.  Returns false if the move turns no layers.
+	 */
+	bool resolve( move m, int & axis, int & first, int & last, int & quarters ) const;
+
+	/*
+	 * Index a sticker moves to when m is applied.  Lets solvers follow a
+	 * few stickers through a move sequence without turning whole layers.
+	 */
+	int moveSticker( int sticker, move m ) const;
+
+	/*
+	 * Writes the indices of all stickers in one layer to out and returns
+	 * how many were written.  out needs room for maxLayerStickers().
+	 */
+	int layerStickers( int axis, int layer, int * out ) const;
+	int maxLayerStickers() const { return 4 * dim + 2 * dim * dim; }
+
+	/*
+	 * Cell coordinates of a sticker.
+	 */
+	void position( int face, int row, int col, int & x, int & y, int & z ) const;
+
+	/*
+	 * Index of the sticker on a face at the given cell coordinates.
+	 * The cell must lie on that face.
+	 */
+	int stickerAt( int face, int x, int y, int z ) const;
+
+	/*
+	 * Index of a slot sticker from cornerSlots/edgeSlots scaled to dim.
+	 */
+	int slotSticker( const int * slot ) const;
+
+	/*
+	 * Outward normal of a face as a unit axis vector.
+	 */
+	static void normal( int face, int & x, int & y, int & z );
+
+	/*
+	 * Face with the given outward normal.
+	 */
+	static int faceFromNormal( int x, int y, int z );
+
+private:
+	int dim;
+	unsigned char * stickers;
+
+	int * ring;				//Scratch: sticker indices around one layer
+	unsigned char * temp;	//Scratch: colors being moved
+
+	/*
+	 * Fills out with the 4*dim stickers around a layer, ordered so that a
+	 * quarter turn moves out[p] to out[p + dim].
+	 */
+	void buildRing( int axis, int layer, int * out ) const;
+
+	/*
+	 * Rotates a whole face counterclockwise (viewed from outside).
+	 */
+	void rotateFace( int face, int quarters );
+
+	void allocate();
+};
+#endif
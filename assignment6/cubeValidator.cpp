@@ -0,0 +1,261 @@
+#include "cubeValidator.h"
+#include <cstring>
+
+//Returns 1 if the permutation is odd
+static int parity( const int * perm, int n ) {
+	int p = 0;
+	for( int i = 0; i < n; i++ ) {
+		for( int j = i + 1; j < n; j++ ) {
+			if( perm[j] < perm[i] ) {
+				p ^= 1;
+			}
+		}
+	}
+	return p;
+}
+
+//Edge slot whose home colors are {a, b}, or -1 if the pair is no edge
+static int edgeFromColors( int a, int b ) {
+	for( int e = 0; e < 12; e++ ) {
+		int h0 = cubeModel::edgeSlots[e][0][0];
+		int h1 = cubeModel::edgeSlots[e][1][0];
+		if( ( a == h0 && b == h1 ) || ( a == h1 && b == h0 ) ) {
+			return e;
+		}
+	}
+	return -1;
+}
+
+//Corner slot whose home colors match (a, b, c) up to rotation.
+//Sets twist to the rotation.  Returns -1 if there is no such corner.
+static int cornerFromColors( const int * c, int & twist ) {
+	for( int k = 0; k < 8; k++ ) {
+		for( int r = 0; r < 3; r++ ) {
+			if( c[0] == cubeModel::cornerSlots[k][r][0]
+				&& c[1] == cubeModel::cornerSlots[k][( r + 1 ) % 3][0]
+				&& c[2] == cubeModel::cornerSlots[k][( r + 2 ) % 3][0] ) {
+					twist = ( 3 - r ) % 3;
+					return k;
+			}
+		}
+	}
+	return -1;
+}
+
+cubeValidator::Result cubeValidator::validate( const cubeModel & state ) {
+	int dim = state.getDimensions();
+	int n = dim - 1;
+	const unsigned char * s = state.getStickers();
+
+	if( dim < 2 ) {
+		return BAD_DIMENSIONS;
+	}
+
+	//Color counts
+	int count[6] = { 0, 0, 0, 0, 0, 0 };
+	for( int i = 0; i < state.getNumStickers(); i++ ) {
+		if( s[i] > 5 ) {
+			return BAD_COLOR;
+		}
+		count[s[i]]++;
+	}
+	for( int c = 0; c < 6; c++ ) {
+		if( count[c] != dim * dim ) {
+			return BAD_COLOR_COUNT;
+		}
+	}
+
+	//Middle centers must be a rotation of the color scheme
+	int centerParity = 0;
+	if( dim % 2 ) {
+		int perm[6];
+		for( int f = 0; f < 6; f++ ) {
+			perm[f] = state.get( f, dim / 2, dim / 2 );
+		}
+		for( int f = 0; f < 6; f++ ) {
+			if( perm[f ^ 1] != ( perm[f] ^ 1 ) ) {
+				return BAD_CENTERS;
+			}
+		}
+		//Determinant of the rotation mapping Right, Top, Front to their colors
+		int m[3][3];
+		int faces[3] = { cubeModel::RIGHT, cubeModel::TOP, cubeModel::FRONT };
+		for( int k = 0; k < 3; k++ ) {
+			cubeModel::normal( perm[faces[k]], m[0][k], m[1][k], m[2][k] );
+		}
+		int det = m[0][0] * ( m[1][1] * m[2][2] - m[1][2] * m[2][1] )
+			- m[0][1] * ( m[1][0] * m[2][2] - m[1][2] * m[2][0] )
+			+ m[0][2] * ( m[1][0] * m[2][1] - m[1][1] * m[2][0] );
+		if( det != 1 ) {
+			return BAD_CENTERS;
+		}
+		centerParity = parity( perm, 6 );
+	}
+
+	//Corners
+	int cornerPerm[8];
+	int seen = 0;
+	int twist = 0;
+	for( int k = 0; k < 8; k++ ) {
+		int c[3];
+		for( int t = 0; t < 3; t++ ) {
+			c[t] = s[state.slotSticker( cubeModel::cornerSlots[k][t] )];
+		}
+		int ori;
+		int piece = cornerFromColors( c, ori );
+		if( piece < 0 ) {
+			return BAD_CORNER;
+		}
+		if( seen & ( 1 << piece ) ) {
+			return DUPLICATE_CORNER;
+		}
+		seen |= 1 << piece;
+		cornerPerm[k] = piece;
+		twist += ori;
+	}
+	if( twist % 3 ) {
+		return CORNER_TWIST;
+	}
+
+	//Middle edges
+	if( dim % 2 && dim > 2 ) {
+		int edgePerm[12];
+		seen = 0;
+		int flip = 0;
+		for( int k = 0; k < 12; k++ ) {
+			int a = s[state.slotSticker( cubeModel::edgeSlots[k][0] )];
+			int b = s[state.slotSticker( cubeModel::edgeSlots[k][1] )];
+			int piece = edgeFromColors( a, b );
+			if( piece < 0 ) {
+				return BAD_EDGE;
+			}
+			if( seen & ( 1 << piece ) ) {
+				return DUPLICATE_EDGE;
+			}
+			seen |= 1 << piece;
+			edgePerm[k] = piece;
+			flip += ( a != cubeModel::edgeSlots[piece][0][0] );
+		}
+		if( flip % 2 ) {
+			return EDGE_FLIP;
+		}
+		if( parity( cornerPerm, 8 ) ^ parity( edgePerm, 12 ) ^ centerParity ) {
+			return PARITY;
+		}
+	}
+
+	//Wings.  A wing is identified by its colors and its handedness, the
+	//sign of (normal of lower color x normal of higher color) dotted with
+	//its offset from the middle of the edge.  Handedness never changes.
+	for( int t = 1; t < n - t; t++ ) {
+		int wings = 0;
+		for( int k = 0; k < 12; k++ ) {
+			const int * first = cubeModel::edgeSlots[k][0];
+			int face2 = cubeModel::edgeSlots[k][1][0];
+			for( int side = 0; side < 2; side++ ) {
+				int offset = side ? n - t : t;
+				int row = first[1] == 1 ? offset : ( first[1] ? n : 0 );
+				int col = first[2] == 1 ? offset : ( first[2] ? n : 0 );
+				int x, y, z;
+				state.position( first[0], row, col, x, y, z );
+				int a = s[state.index( first[0], row, col )];
+				int b = s[state.stickerAt( face2, x, y, z )];
+				int piece = edgeFromColors( a, b );
+				if( piece < 0 ) {
+					return BAD_WING;
+				}
+
+				int na[3], nb[3], axis[3];
+				cubeModel::normal( first[0], na[0], na[1], na[2] );
+				cubeModel::normal( face2, nb[0], nb[1], nb[2] );
+				if( a > b ) {
+					for( int i = 0; i < 3; i++ ) {
+						int temp = na[i];
+						na[i] = nb[i];
+						nb[i] = temp;
+					}
+				}
+				axis[0] = na[1] * nb[2] - na[2] * nb[1];
+				axis[1] = na[2] * nb[0] - na[0] * nb[2];
+				axis[2] = na[0] * nb[1] - na[1] * nb[0];
+				int along = axis[0] * ( 2 * x - n ) + axis[1] * ( 2 * y - n ) + axis[2] * ( 2 * z - n );
+
+				int id = piece * 2 + ( along > 0 );
+				if( wings & ( 1 << id ) ) {
+					return BAD_WING;
+				}
+				wings |= 1 << id;
+			}
+		}
+	}
+
+	//Center orbits.  Each orbit is keyed by the smallest of the four
+	//rotations of its position on a face.
+	if( dim > 3 ) {
+		unsigned char * orbit = new unsigned char[dim * dim * 6];
+		memset( orbit, 0, dim * dim * 6 );
+		for( int f = 0; f < 6; f++ ) {
+			for( int i = 1; i < n; i++ ) {
+				for( int j = 1; j < n; j++ ) {
+					int key = i * dim + j;
+					int r = i, c = j;
+					for( int rot = 0; rot < 3; rot++ ) {
+						int temp = r;
+						r = c;
+						c = n - temp;
+						if( r * dim + c < key ) {
+							key = r * dim + c;
+						}
+					}
+					orbit[key * 6 + s[state.index( f, i, j )]]++;
+				}
+			}
+		}
+		bool ok = true;
+		for( int i = 1; i < n && ok; i++ ) {
+			for( int j = 1; j < n && ok; j++ ) {
+				if( 2 * i == n && 2 * j == n ) {
+					continue;	//Middle center, checked above
+				}
+				int total = 0;
+				for( int c = 0; c < 6; c++ ) {
+					total += orbit[( i * dim + j ) * 6 + c];
+				}
+				if( total == 0 ) {
+					continue;	//Not the key of its orbit
+				}
+				for( int c = 0; c < 6; c++ ) {
+					if( orbit[( i * dim + j ) * 6 + c] != 4 ) {
+						ok = false;
+					}
+				}
+			}
+		}
+		delete [] orbit;
+		if( !ok ) {
+			return BAD_CENTER_ORBIT;
+		}
+	}
+
+	return VALID;
+}
+
+const char * cubeValidator::describe( Result result ) {
+	switch( result ) {
+		case VALID:				return "valid";
+		case BAD_DIMENSIONS:	return "cube must be at least 2x2";
+		case BAD_COLOR:			return "sticker has an invalid color";
+		case BAD_COLOR_COUNT:	return "color does not appear dim*dim times";
+		case BAD_CENTERS:		return "centers do not form the color scheme";
+		case BAD_CORNER:		return "corner colors do not form a corner";
+		case DUPLICATE_CORNER:	return "corner appears twice";
+		case CORNER_TWIST:		return "twisted corner";
+		case BAD_EDGE:			return "edge colors do not form an edge";
+		case DUPLICATE_EDGE:	return "edge appears twice";
+		case EDGE_FLIP:			return "flipped edge";
+		case PARITY:			return "permutation parity mismatch";
+		case BAD_WING:			return "wing edge missing, duplicated or flipped";
+		case BAD_CENTER_ORBIT:	return "center orbit has wrong colors";
+	}
+	return "unknown";
+}
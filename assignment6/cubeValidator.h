@@ -0,0 +1,55 @@
+//Header file for Rubiks cube project
+#ifndef CUBEVALIDATOR_H
+#define CUBEVALIDATOR_H
+#include "cubeModel.h"
+
+/*
+ * Checks whether a sticker coloring can be reached from the solved cube
+ * using layer turns and whole cube rotations.  Runs in O(stickers) time
+ * without any search so states can be rejected at import.
+ *
+ * Checks performed:
+ *	- every sticker is a valid color and each color appears dim*dim times
+ *	- odd cubes: the six middle centers form the standard color scheme
+ *	- every corner is a real corner (no opposite colors, not mirrored),
+ *	  each appears once and the twists sum to 0 mod 3
+ *	- odd cubes: every middle edge appears once, the flips sum to
+ *	  0 mod 2 and corner, edge and center permutation parities agree
+ *	- wing edges (dim >= 4): each of the 24 wings in an orbit appears
+ *	  exactly once, which also rules out flipped wings
+ *	- center orbits (dim >= 4): each orbit of 24 centers holds four of
+ *	  every color
+ *
+ * Wing and inner center parity are not constrained: same colored centers
+ * can be swapped freely, which absorbs any odd wing permutation.
+ */
+class cubeValidator {
+public:
+	enum Result {
+		VALID = 0,
+		BAD_DIMENSIONS,		//dim < 2
+		BAD_COLOR,			//Sticker value out of range
+		BAD_COLOR_COUNT,	//A color does not appear dim*dim times
+		BAD_CENTERS,		//Middle centers do not form the color scheme
+		BAD_CORNER,			//Corner colors do not form a real corner
+		DUPLICATE_CORNER,	//Same corner appears twice
+		CORNER_TWIST,		//Corner twists do not sum to 0 mod 3
+		BAD_EDGE,			//Edge colors do not form a real edge
+		DUPLICATE_EDGE,		//Same edge appears twice
+		EDGE_FLIP,			//Edge flips do not sum to 0 mod 2
+		PARITY,				//Permutation parity mismatch
+		BAD_WING,			//Wing edge missing, duplicated or flipped
+		BAD_CENTER_ORBIT	//Center orbit does not hold four of each color
+	};
+
+	/*
+	 * Validates a state.  Returns VALID or the first failed check.
+	 */
+	static Result validate( const cubeModel & state );
+
+	/*
+	 * Human readable message for a result.
+	 */
+	static const char * describe( Result result );
+};
+#endif
@@ -0,0 +1,420 @@
+#include "cubieCube.h"
+#include <cstring>
+
+//Quarter turns of U R F D L B
+static const unsigned char moveCp[6][8] = {
+	{ 3, 0, 1, 2, 4, 5, 6, 7 },
+	{ 4, 1, 2, 0, 7, 5, 6, 3 },
+	{ 1, 5, 2, 3, 0, 4, 6, 7 },
+	{ 0, 1, 2, 3, 5, 6, 7, 4 },
+	{ 0, 2, 6, 3, 4, 1, 5, 7 },
+	{ 0, 1, 3, 7, 4, 5, 2, 6 }
+};
+static const unsigned char moveCo[6][8] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 2, 0, 0, 1, 1, 0, 0, 2 },
+	{ 1, 2, 0, 0, 2, 1, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 0, 0, 2, 1, 0 },
+	{ 0, 0, 1, 2, 0, 0, 2, 1 }
+};
+static const unsigned char moveEp[6][12] = {
+	{ 3, 0, 1, 2, 4, 5, 6, 7, 8, 9, 10, 11 },
+	{ 8, 1, 2, 3, 11, 5, 6, 7, 4, 9, 10, 0 },
+	{ 0, 9, 2, 3, 4, 8, 6, 7, 1, 5, 10, 11 },
+	{ 0, 1, 2, 3, 5, 6, 7, 4, 8, 9, 10, 11 },
+	{ 0, 1, 10, 3, 4, 5, 9, 7, 8, 2, 6, 11 },
+	{ 0, 1, 2, 11, 4, 5, 6, 10, 8, 9, 3, 7 }
+};
+static const unsigned char moveEo[6][12] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1 }
+};
+
+//cubeModel face for U R F D L B
+static const int modelFace[6] = {
+	cubeModel::TOP, cubeModel::RIGHT, cubeModel::FRONT,
+	cubeModel::BOTTOM, cubeModel::LEFT, cubeModel::BACK
+};
+
+cubieCube::cubieCube() {
+	for( int i = 0; i < 8; i++ ) {
+		cp[i] = i;
+		co[i] = 0;
+	}
+	for( int i = 0; i < 12; i++ ) {
+		ep[i] = i;
+		eo[i] = 0;
+	}
+}
+
+bool cubieCube::isSolved() const {
+	for( int i = 0; i < 8; i++ ) {
+		if( cp[i] != i || co[i] ) {
+			return false;
+		}
+	}
+	for( int i = 0; i < 12; i++ ) {
+		if( ep[i] != i || eo[i] ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void cubieCube::multiply( const cubieCube & b ) {
+	unsigned char p[12], o[12];
+	for( int i = 0; i < 8; i++ ) {
+		p[i] = cp[b.cp[i]];
+		o[i] = ( co[b.cp[i]] + b.co[i] ) % 3;
+	}
+	memcpy( cp, p, 8 );
+	memcpy( co, o, 8 );
+	for( int i = 0; i < 12; i++ ) {
+		p[i] = ep[b.ep[i]];
+		o[i] = ( eo[b.ep[i]] + b.eo[i] ) & 1;
+	}
+	memcpy( ep, p, 12 );
+	memcpy( eo, o, 12 );
+}
+
+const cubieCube & cubieCube::faceMove( int face ) {
+	static cubieCube moves[6];
+	static bool initialized = false;
+	if( !initialized ) {
+		for( int f = 0; f < 6; f++ ) {
+			memcpy( moves[f].cp, moveCp[f], 8 );
+			memcpy( moves[f].co, moveCo[f], 8 );
+			memcpy( moves[f].ep, moveEp[f], 12 );
+			memcpy( moves[f].eo, moveEo[f], 12 );
+		}
+		initialized = true;
+	}
+	return moves[face];
+}
+
+void cubieCube::move( int m ) {
+	const cubieCube & turn = faceMove( m / 3 );
+	for( int q = m % 3; q >= 0; q-- ) {
+		multiply( turn );
+	}
+}
+
+cubieCube cubieCube::inverse() const {
+	cubieCube inv;
+	for( int i = 0; i < 8; i++ ) {
+		inv.cp[cp[i]] = i;
+	}
+	for( int i = 0; i < 8; i++ ) {
+		inv.co[i] = ( 3 - co[inv.cp[i]] ) % 3;
+	}
+	for( int i = 0; i < 12; i++ ) {
+		inv.ep[ep[i]] = i;
+	}
+	for( int i = 0; i < 12; i++ ) {
+		inv.eo[i] = eo[inv.ep[i]];
+	}
+	return inv;
+}
+
+//xorshift generator, state must be non-zero
+static unsigned int nextRandom( unsigned int & seed ) {
+	if( seed == 0 ) {
+		seed = 0x9E3779B9u;
+	}
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+//Fisher-Yates shuffle, returns the parity of the permutation
+static int shuffle( unsigned char * perm, int n, unsigned int & seed ) {
+	int parity = 0;
+	for( int i = n - 1; i > 0; i-- ) {
+		int j = nextRandom( seed ) % ( i + 1 );
+		if( j != i ) {
+			unsigned char temp = perm[i];
+			perm[i] = perm[j];
+			perm[j] = temp;
+			parity ^= 1;
+		}
+	}
+	return parity;
+}
+
+void cubieCube::randomize( unsigned int & seed ) {
+	*this = cubieCube();
+	int cornerParity = shuffle( cp, 8, seed );
+	int edgeParity = shuffle( ep, 12, seed );
+	if( cornerParity != edgeParity ) {
+		unsigned char temp = ep[0];
+		ep[0] = ep[1];
+		ep[1] = temp;
+	}
+	int twist = 0, flip = 0;
+	for( int i = 0; i < 7; i++ ) {
+		co[i] = nextRandom( seed ) % 3;
+		twist += co[i];
+	}
+	co[7] = ( 3 - twist % 3 ) % 3;
+	for( int i = 0; i < 11; i++ ) {
+		eo[i] = nextRandom( seed ) & 1;
+		flip += eo[i];
+	}
+	eo[11] = flip & 1;
+}
+
+bool cubieCube::fromModel( const cubeModel & state ) {
+	if( state.getDimensions() != 3 ) {
+		return false;
+	}
+
+	//Color of each center maps to the face it is on
+	int home[6];
+	for( int f = 0; f < 6; f++ ) {
+		home[state.get( f, 1, 1 )] = f;
+	}
+	const unsigned char * s = state.getStickers();
+
+	int seenCorners = 0;
+	for( int i = 0; i < 8; i++ ) {
+		int c[3];
+		for( int t = 0; t < 3; t++ ) {
+			c[t] = home[s[state.slotSticker( cubeModel::cornerSlots[i][t] )]];
+		}
+		int ori;
+		for( ori = 0; ori < 3; ori++ ) {
+			if( c[ori] == cubeModel::TOP || c[ori] == cubeModel::BOTTOM ) {
+				break;
+			}
+		}
+		if( ori == 3 ) {
+			return false;
+		}
+		int j;
+		for( j = 0; j < 8; j++ ) {
+			if( c[ori] == cubeModel::cornerSlots[j][0][0]
+				&& c[( ori + 1 ) % 3] == cubeModel::cornerSlots[j][1][0]
+				&& c[( ori + 2 ) % 3] == cubeModel::cornerSlots[j][2][0] ) {
+					break;
+			}
+		}
+		if( j == 8 || ( seenCorners & ( 1 << j ) ) ) {
+			return false;
+		}
+		seenCorners |= 1 << j;
+		cp[i] = j;
+		co[i] = ori;
+	}
+
+	int seenEdges = 0;
+	for( int i = 0; i < 12; i++ ) {
+		int a = home[s[state.slotSticker( cubeModel::edgeSlots[i][0] )]];
+		int b = home[s[state.slotSticker( cubeModel::edgeSlots[i][1] )]];
+		int j;
+		for( j = 0; j < 12; j++ ) {
+			int h0 = cubeModel::edgeSlots[j][0][0];
+			int h1 = cubeModel::edgeSlots[j][1][0];
+			if( a == h0 && b == h1 ) {
+				eo[i] = 0;
+				break;
+			}
+			if( a == h1 && b == h0 ) {
+				eo[i] = 1;
+				break;
+			}
+		}
+		if( j == 12 || ( seenEdges & ( 1 << j ) ) ) {
+			return false;
+		}
+		seenEdges |= 1 << j;
+		ep[i] = j;
+	}
+	return true;
+}
+
+void cubieCube::toModel( cubeModel & state ) const {
+	state.reset();
+	unsigned char * s = state.getStickers();
+	for( int i = 0; i < 8; i++ ) {
+		for( int t = 0; t < 3; t++ ) {
+			s[state.slotSticker( cubeModel::cornerSlots[i][( t + co[i] ) % 3] )] =
+				cubeModel::cornerSlots[cp[i]][t][0];
+		}
+	}
+	for( int i = 0; i < 12; i++ ) {
+		for( int t = 0; t < 2; t++ ) {
+			s[state.slotSticker( cubeModel::edgeSlots[i][( t + eo[i] ) & 1] )] =
+				cubeModel::edgeSlots[ep[i]][t][0];
+		}
+	}
+}
+
+cubeModel::move cubieCube::toMove( int m ) {
+	return cubeModel::makeMove( modelFace[m / 3], m % 3 + 1, 0, 0 );
+}
+
+void cubieCube::appendMove( std::vector<unsigned char> & moves, int m ) {
+	if( !moves.empty() && moveFace( moves.back() ) == moveFace( m ) ) {
+		int quarters = ( moves.back() % 3 + m % 3 + 2 ) % 4;
+		int face = moveFace( m );
+		moves.pop_back();
+		if( quarters ) {
+			moves.push_back( (unsigned char)( face * 3 + quarters - 1 ) );
+		}
+		return;
+	}
+	moves.push_back( (unsigned char)m );
+}
+
+int cubieCube::choose( int n, int k ) {
+	if( k < 0 || k > n ) {
+		return 0;
+	}
+	int result = 1;
+	for( int i = 0; i < k; i++ ) {
+		result = result * ( n - i ) / ( i + 1 );
+	}
+	return result;
+}
+
+int cubieCube::permIndex( const unsigned char * perm, int n ) {
+	int index = 0;
+	for( int i = 0; i < n; i++ ) {
+		int smaller = 0;
+		for( int j = i + 1; j < n; j++ ) {
+			if( perm[j] < perm[i] ) {
+				smaller++;
+			}
+		}
+		index = index * ( n - i ) + smaller;
+	}
+	return index;
+}
+
+void cubieCube::permFromIndex( int index, unsigned char * perm, int n ) {
+	int digits[12];
+	for( int i = n - 1; i >= 0; i-- ) {
+		digits[i] = index % ( n - i );
+		index /= n - i;
+	}
+	int used = 0;
+	for( int i = 0; i < n; i++ ) {
+		int k = digits[i];
+		int v;
+		for( v = 0; v < n; v++ ) {
+			if( !( used & ( 1 << v ) ) ) {
+				if( k == 0 ) {
+					break;
+				}
+				k--;
+			}
+		}
+		perm[i] = v;
+		used |= 1 << v;
+	}
+}
+
+int cubieCube::getTwist() const {
+	int twist = 0;
+	for( int i = 0; i < 7; i++ ) {
+		twist = twist * 3 + co[i];
+	}
+	return twist;
+}
+
+void cubieCube::setTwist( int twist ) {
+	int sum = 0;
+	for( int i = 6; i >= 0; i-- ) {
+		co[i] = twist % 3;
+		sum += co[i];
+		twist /= 3;
+	}
+	co[7] = ( 3 - sum % 3 ) % 3;
+}
+
+int cubieCube::getFlip() const {
+	int flip = 0;
+	for( int i = 0; i < 11; i++ ) {
+		flip = flip * 2 + eo[i];
+	}
+	return flip;
+}
+
+void cubieCube::setFlip( int flip ) {
+	int sum = 0;
+	for( int i = 10; i >= 0; i-- ) {
+		eo[i] = flip & 1;
+		sum += eo[i];
+		flip >>= 1;
+	}
+	eo[11] = sum & 1;
+}
+
+int cubieCube::getSlice() const {
+	int slice = 0, seen = 0;
+	for( int j = 11; j >= 0; j-- ) {
+		if( ep[j] >= 8 ) {
+			slice += choose( 11 - j, seen + 1 );
+			seen++;
+		}
+	}
+	return slice;
+}
+
+void cubieCube::setSlice( int slice ) {
+	//Slice edges keep their order, the others are placed in order too
+	int seen = 4;
+	int next = 11, other = 7;
+	bool isSlice[12];
+	for( int j = 0; j < 12; j++ ) {
+		isSlice[j] = false;
+	}
+	for( int j = 0; j < 12 && seen > 0; j++ ) {
+		int c = choose( 11 - j, seen );
+		if( slice >= c ) {
+			slice -= c;
+			isSlice[j] = true;
+			seen--;
+		}
+	}
+	for( int j = 11; j >= 0; j-- ) {
+		ep[j] = isSlice[j] ? next-- : other--;
+	}
+}
+
+int cubieCube::getCornerPerm() const {
+	return permIndex( cp, 8 );
+}
+
+void cubieCube::setCornerPerm( int perm ) {
+	permFromIndex( perm, cp, 8 );
+}
+
+int cubieCube::getEdgePerm() const {
+	return permIndex( ep, 8 );
+}
+
+void cubieCube::setEdgePerm( int perm ) {
+	permFromIndex( perm, ep, 8 );
+}
+
+int cubieCube::getSlicePerm() const {
+	unsigned char perm[4];
+	for( int i = 0; i < 4; i++ ) {
+		perm[i] = ep[8 + i] - 8;
+	}
+	return permIndex( perm, 4 );
+}
+
+void cubieCube::setSlicePerm( int perm ) {
+	permFromIndex( perm, ep + 8, 4 );
+	for( int i = 8; i < 12; i++ ) {
+		ep[i] += 8;
+	}
+}
@@ -0,0 +1,119 @@
+//Header file for Rubiks cube project
+#ifndef CUBIECUBE_H
+#define CUBIECUBE_H
+#include "cubeModel.h"
+#include <vector>
+
+/*
+ * 3x3 cube on the cubie level: permutation and orientation of the 8
+ * corners and 12 edges, in the slot order of cubeModel::cornerSlots and
+ * cubeModel::edgeSlots.  Used by the solvers, which work on coordinates
+ * computed from this representation rather than on stickers.
+ *
+ * Moves are numbered face * 3 + (quarter turns - 1) with faces in the
+ * order U R F D L B (the usual order for two-phase solvers).
+ */
+class cubieCube {
+public:
+	enum { U = 0, R, F, D, L, B };
+	enum { NUM_MOVES = 18 };
+
+	unsigned char cp[8];	//Corner in each slot
+	unsigned char co[8];	//Corner twist, 0-2
+	unsigned char ep[12];	//Edge in each slot
+	unsigned char eo[12];	//Edge flip, 0-1
+
+	/*
+	 * Creates a solved cube
+	 */
+	cubieCube();
+
+	/*
+	 * Returns whether the cube is solved.
+	 */
+	bool isSolved() const;
+
+	/*
+	 * Applies b after this cube: this = this * b.
+	 */
+	void multiply( const cubieCube & b );
+
+	/*
+	 * Applies one of the 18 moves.
+	 */
+	void move( int m );
+
+	/*
+	 * Returns the inverse cube.
+	 */
+	cubieCube inverse() const;
+
+	/*
+	 * Random solvable cube, every state equally likely.  seed is the
+	 * state of a private generator so threads can use their own.
+	 */
+	void randomize( unsigned int & seed );
+
+	/*
+	 * Reads the cubies of a 3x3 sticker state.  Colors are taken
+	 * relative to the centers, so whole cube rotations do not matter.
+	 * Returns false if the stickers do not form a valid cube.
+	 */
+	bool fromModel( const cubeModel & state );
+
+	/*
+	 * Writes the cubies to a 3x3 sticker state with solved centers.
+	 */
+	void toModel( cubeModel & state ) const;
+
+	/*
+	 * Packed move for cubeModel.  The face is converted to cubeModel's
+	 * face numbering.
+	 */
+	static cubeModel::move toMove( int m );
+
+	/*
+	 * Face of a move, U R F D L B.
+	 */
+	static int moveFace( int m ) { return m / 3; }
+
+	/*
+	 * Appends a move to a move list, merged with the last move if that
+	 * turns the same face (both dropped if they cancel).
+	 */
+	static void appendMove( std::vector<unsigned char> & moves, int m );
+
+	/*
+	 * Coordinates used by the solvers.  Each is 0 for the solved cube.
+	 */
+	int getTwist() const;		//Corner orientation, 0 - 2186
+	int getFlip() const;		//Edge orientation, 0 - 2047
+	int getSlice() const;		//Positions of FR FL BL BR, 0 - 494
+	int getCornerPerm() const;	//Corner permutation, 0 - 40319
+	int getEdgePerm() const;	//U/D edge permutation (phase 2 only), 0 - 40319
+	int getSlicePerm() const;	//FR FL BL BR permutation (phase 2 only), 0 - 23
+
+	void setTwist( int twist );
+	void setFlip( int flip );
+	void setSlice( int slice );
+	void setCornerPerm( int perm );
+	void setEdgePerm( int perm );
+	void setSlicePerm( int perm );
+
+	/*
+	 * The basic cubes for the six quarter turns.
+	 */
+	static const cubieCube & faceMove( int face );
+
+	/*
+	 * Binomial coefficient, 0 when k > n.
+	 */
+	static int choose( int n, int k );
+
+	/*
+	 * Lehmer code of a permutation of n values and its inverse.
+	 */
+	static int permIndex( const unsigned char * perm, int n );
+	static void permFromIndex( int index, unsigned char * perm, int n );
+};
+#endif
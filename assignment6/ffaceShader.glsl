@@ -1,16 +1,18 @@
 #version 150
 
-uniform bool cursor;
-uniform vec4 highlight;
+uniform float time;		//Seconds since the cursor pulse started
 
 in  vec4 fColor;
+in  float fCursor;
 out vec4 color;
 
 void main() 
 { 
     color = fColor;
-	if( cursor ) {
-		color += highlight;
+	if( fCursor > 0.5 ) {
+		//Highlight falls from 0.5 to 0 and back every 2/3 second
+		float h = 0.5 * abs( 2.0 * fract( time * 1.5 ) - 1.0 );
+		color.rgb += vec3( h );
 	}
 } 
 
@@ -0,0 +1,36 @@
+#version 150
+
+uniform sampler2D stickers;	//Palette index of each sticker, sides in 3 columns and 2 rows
+uniform vec4 palette[6];	//Color of each palette index
+uniform int dim;			//Dimensions of the cube
+uniform int cursor;			//Sticker under the cursor, -1 for none
+uniform float time;			//Seconds since the cursor pulse started
+
+in  vec2 fSticker;
+flat in int fSide;
+out vec4 color;
+
+void main() 
+{ 
+	//Inside of the cube, shown by a turn
+	if( fSide < 0 ) {
+		color = vec4( 0.0, 0.0, 0.0, 1.0 );
+		return;
+	}
+
+	ivec2 sticker = clamp( ivec2( floor( fSticker ) ), ivec2( 0 ), ivec2( dim - 1 ) );
+	ivec2 texel = ivec2( fSide % 3, fSide / 3 ) * dim + sticker;
+	color = palette[int( texelFetch( stickers, texel, 0 ).r * 255.0 + 0.5 )];
+	if( fSide * dim * dim + sticker.y * dim + sticker.x == cursor ) {
+		//Same pulse as ffaceShader.glsl
+		float h = 0.5 * abs( 2.0 * fract( time * 1.5 ) - 1.0 );
+		color.rgb += vec3( h );
+	}
+
+	//Black gaps like the sticker geometry leaves, blended to their average
+	//once they are thinner than a pixel
+	vec2 edge = min( fract( fSticker ), 1.0 - fract( fSticker ) );
+	vec2 width = fwidth( fSticker );
+	vec2 inside = smoothstep( vec2( 0.05 ) - width, vec2( 0.05 ) + width, edge );
+	color.rgb *= inside.x * inside.y;
+} 
@@ -0,0 +1,441 @@
+#include "kociemba.h"
+#include "pruneTable.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+const int kociembaSolver::phase2Moves[NUM_PHASE2_MOVES] = { 0, 1, 2, 4, 7, 9, 10, 11, 13, 16 };
+
+//Table file header
+struct kociembaHeader {
+	char magic[8];
+	unsigned int version;
+	unsigned int size;
+};
+static const char tableMagic[8] = { 'R', 'K', 'C', 'M', 'B', 'T', 'B', 'L' };
+static const unsigned int tableVersion = 1;
+
+//Offsets of each table in the file
+struct kociembaLayout {
+	size_t twistMove, flipMove, sliceMove, cornerMove, edgeMove, slicePermMove;
+	size_t sliceTwistPrune, sliceFlipPrune, cornerPrune, edgePrune;
+	size_t total;
+
+	kociembaLayout() {
+		size_t at = sizeof( kociembaHeader );
+		twistMove = reserve( at, kociembaSolver::NUM_TWIST * 18 * 2 );
+		flipMove = reserve( at, kociembaSolver::NUM_FLIP * 18 * 2 );
+		sliceMove = reserve( at, kociembaSolver::NUM_SLICE * 18 * 2 );
+		cornerMove = reserve( at, kociembaSolver::NUM_PERM * kociembaSolver::NUM_PHASE2_MOVES * 2 );
+		edgeMove = reserve( at, kociembaSolver::NUM_PERM * kociembaSolver::NUM_PHASE2_MOVES * 2 );
+		slicePermMove = reserve( at, kociembaSolver::NUM_SLICE_PERM * kociembaSolver::NUM_PHASE2_MOVES * 2 );
+		sliceTwistPrune = reserve( at, ( kociembaSolver::NUM_SLICE * kociembaSolver::NUM_TWIST + 1 ) / 2 );
+		sliceFlipPrune = reserve( at, ( kociembaSolver::NUM_SLICE * kociembaSolver::NUM_FLIP + 1 ) / 2 );
+		cornerPrune = reserve( at, ( kociembaSolver::NUM_SLICE_PERM * kociembaSolver::NUM_PERM + 1 ) / 2 );
+		edgePrune = reserve( at, ( kociembaSolver::NUM_SLICE_PERM * kociembaSolver::NUM_PERM + 1 ) / 2 );
+		total = at;
+	}
+
+	//Returns the offset for a block of bytes, 8 byte aligned
+	static size_t reserve( size_t & at, size_t bytes ) {
+		size_t offset = at;
+		at = ( at + bytes + 7 ) & ~(size_t)7;
+		return offset;
+	}
+};
+
+static inline int getNibble( const unsigned char * table, int index ) {
+	return ( table[index >> 1] >> ( ( index & 1 ) << 2 ) ) & 15;
+}
+
+/*
+ * Move tables of a pruning table over two coordinates,
+ * index = a * sizeB + b, each with numMoves columns.
+ */
+struct pruneMoves {
+	const unsigned short * moveA;
+	const unsigned short * moveB;
+	int sizeB;
+	int numMoves;
+};
+
+static int expandPrune( int index, int * out, const void * data ) {
+	const pruneMoves & p = *(const pruneMoves *)data;
+	int a = index / p.sizeB;
+	int b = index % p.sizeB;
+	for( int m = 0; m < p.numMoves; m++ ) {
+		out[m] = p.moveA[a * p.numMoves + m] * p.sizeB + p.moveB[b * p.numMoves + m];
+	}
+	return p.numMoves;
+}
+
+static void buildPrune( unsigned char * table, int sizeA, int sizeB,
+	const unsigned short * moveA, const unsigned short * moveB, int numMoves, const char * name ) {
+	pruneMoves moves = { moveA, moveB, sizeB, numMoves };
+	pruneTable::fill( table, sizeA * sizeB, 0, expandPrune, &moves, name );
+}
+
+kociembaSolver::kociembaSolver() {
+	generated = NULL;
+	twistMove = flipMove = sliceMove = cornerMove = edgeMove = slicePermMove = NULL;
+	sliceTwistPrune = sliceFlipPrune = cornerPrune = edgePrune = NULL;
+}
+
+kociembaSolver::~kociembaSolver() {
+	delete [] generated;
+}
+
+void kociembaSolver::setTables( const unsigned char * base ) {
+	kociembaLayout layout;
+	twistMove = (const unsigned short *)( base + layout.twistMove );
+	flipMove = (const unsigned short *)( base + layout.flipMove );
+	sliceMove = (const unsigned short *)( base + layout.sliceMove );
+	cornerMove = (const unsigned short *)( base + layout.cornerMove );
+	edgeMove = (const unsigned short *)( base + layout.edgeMove );
+	slicePermMove = (const unsigned short *)( base + layout.slicePermMove );
+	sliceTwistPrune = base + layout.sliceTwistPrune;
+	sliceFlipPrune = base + layout.sliceFlipPrune;
+	cornerPrune = base + layout.cornerPrune;
+	edgePrune = base + layout.edgePrune;
+}
+
+bool kociembaSolver::load( const char * path ) {
+	kociembaLayout layout;
+	if( file.open( path ) && file.getSize() == layout.total ) {
+		const kociembaHeader * header = (const kociembaHeader *)file.getData();
+		if( memcmp( header->magic, tableMagic, 8 ) == 0 && header->version == tableVersion
+			&& header->size == layout.total ) {
+				setTables( (const unsigned char *)file.getData() );
+				return true;
+		}
+	}
+	file.close();
+
+	std::cout << "Generating solver tables..." << std::endl;
+	size_t size;
+	delete [] generated;
+	generated = generate( size );
+	if( !generated ) {
+		return false;
+	}
+	if( !mappedFile::write( path, generated, size ) ) {
+		std::cerr << "Could not save solver tables to " << path << std::endl;
+	}
+	setTables( generated );
+	return true;
+}
+
+unsigned char * kociembaSolver::generate( size_t & size ) {
+	kociembaLayout layout;
+	size = layout.total;
+	unsigned char * base = new unsigned char[size];
+	memset( base, 0, size );
+	kociembaHeader * header = (kociembaHeader *)base;
+	memcpy( header->magic, tableMagic, 8 );
+	header->version = tableVersion;
+	header->size = (unsigned int)size;
+
+	unsigned short * twist = (unsigned short *)( base + layout.twistMove );
+	unsigned short * flip = (unsigned short *)( base + layout.flipMove );
+	unsigned short * slice = (unsigned short *)( base + layout.sliceMove );
+	unsigned short * corner = (unsigned short *)( base + layout.cornerMove );
+	unsigned short * edge = (unsigned short *)( base + layout.edgeMove );
+	unsigned short * slicePerm = (unsigned short *)( base + layout.slicePermMove );
+
+	//Phase 1 move tables
+	for( int i = 0; i < NUM_TWIST; i++ ) {
+		for( int m = 0; m < 18; m++ ) {
+			cubieCube c;
+			c.setTwist( i );
+			c.move( m );
+			twist[i * 18 + m] = c.getTwist();
+		}
+	}
+	for( int i = 0; i < NUM_FLIP; i++ ) {
+		for( int m = 0; m < 18; m++ ) {
+			cubieCube c;
+			c.setFlip( i );
+			c.move( m );
+			flip[i * 18 + m] = c.getFlip();
+		}
+	}
+	for( int i = 0; i < NUM_SLICE; i++ ) {
+		for( int m = 0; m < 18; m++ ) {
+			cubieCube c;
+			c.setSlice( i );
+			c.move( m );
+			slice[i * 18 + m] = c.getSlice();
+		}
+	}
+
+	//Phase 2 move tables
+	for( int i = 0; i < NUM_PERM; i++ ) {
+		for( int m = 0; m < NUM_PHASE2_MOVES; m++ ) {
+			cubieCube c;
+			c.setCornerPerm( i );
+			c.move( phase2Moves[m] );
+			corner[i * NUM_PHASE2_MOVES + m] = c.getCornerPerm();
+
+			cubieCube e;
+			e.setEdgePerm( i );
+			e.move( phase2Moves[m] );
+			edge[i * NUM_PHASE2_MOVES + m] = e.getEdgePerm();
+		}
+	}
+	for( int i = 0; i < NUM_SLICE_PERM; i++ ) {
+		for( int m = 0; m < NUM_PHASE2_MOVES; m++ ) {
+			cubieCube c;
+			c.setSlicePerm( i );
+			c.move( phase2Moves[m] );
+			slicePerm[i * NUM_PHASE2_MOVES + m] = c.getSlicePerm();
+		}
+	}
+
+	//Pruning tables
+	buildPrune( base + layout.sliceTwistPrune, NUM_SLICE, NUM_TWIST, slice, twist, 18, "slice/twist" );
+	buildPrune( base + layout.sliceFlipPrune, NUM_SLICE, NUM_FLIP, slice, flip, 18, "slice/flip" );
+	buildPrune( base + layout.cornerPrune, NUM_SLICE_PERM, NUM_PERM, slicePerm, corner, NUM_PHASE2_MOVES,
+		"phase 2 corner" );
+	buildPrune( base + layout.edgePrune, NUM_SLICE_PERM, NUM_PERM, slicePerm, edge, NUM_PHASE2_MOVES,
+		"phase 2 edge" );
+	return base;
+}
+
+//Moves on the same face never follow each other, and moves on opposite
+//faces are only tried in one order.
+static inline bool allowedAfter( int m, int previous ) {
+	if( previous < 0 ) {
+		return true;
+	}
+	int face = m / 3;
+	int last = previous / 3;
+	return face != last && face != last - 3;
+}
+
+static inline bool isPhase2Move( int m ) {
+	int face = m / 3;
+	return face == cubieCube::U || face == cubieCube::D || m % 3 == 1;
+}
+
+/*
+ * State of one solve.  Kept separate from the solver so a single set of
+ * tables can serve several solves at once.
+ */
+class kociembaSearch {
+public:
+	kociembaSearch( const kociembaSolver & solver, const cubieCube & cube, int maxLength, long probeLimit,
+		const std::atomic<bool> * cancel )
+		: solver( solver ), cube( cube ), maxLength( maxLength ), probeLimit( probeLimit ), probes( 0 ),
+		cancel( cancel ) {
+	}
+
+	int run( unsigned char * out ) {
+		int twist = cube.getTwist();
+		int flip = cube.getFlip();
+		int slice = cube.getSlice();
+		for( int depth = 0; depth <= maxLength; depth++ ) {
+			if( phase1( twist, flip, slice, 0, depth ) ) {
+				memcpy( out, moves, length );
+				return length;
+			}
+			if( stopped() ) {
+				break;
+			}
+		}
+		return -1;
+	}
+
+private:
+	const kociembaSolver & solver;
+	cubieCube cube;
+	int maxLength;
+	long probeLimit;
+	long probes;
+	const std::atomic<bool> * cancel;
+	unsigned char moves[64];
+	int length;
+
+	//Probe limit reached or cancelled from another thread?
+	bool stopped() const {
+		return ( probeLimit && probes >= probeLimit )
+			|| ( cancel && cancel->load( std::memory_order_relaxed ) );
+	}
+
+	bool phase1( int twist, int flip, int slice, int depth, int togo ) {
+		if( togo == 0 ) {
+			if( twist || flip || slice ) {
+				return false;
+			}
+			//A phase 1 ending in a phase 2 move was already tried shorter
+			if( depth > 0 && isPhase2Move( moves[depth - 1] ) ) {
+				return false;
+			}
+			return startPhase2( depth );
+		}
+		int previous = depth > 0 ? moves[depth - 1] : -1;
+		for( int m = 0; m < 18; m++ ) {
+			if( !allowedAfter( m, previous ) ) {
+				continue;
+			}
+			int t = solver.twistMove[twist * 18 + m];
+			int f = solver.flipMove[flip * 18 + m];
+			int s = solver.sliceMove[slice * 18 + m];
+			int bound = getNibble( solver.sliceTwistPrune, s * kociembaSolver::NUM_TWIST + t );
+			int bound2 = getNibble( solver.sliceFlipPrune, s * kociembaSolver::NUM_FLIP + f );
+			if( bound2 > bound ) {
+				bound = bound2;
+			}
+			if( bound >= togo ) {
+				continue;
+			}
+			moves[depth] = m;
+			if( phase1( t, f, s, depth + 1, togo - 1 ) ) {
+				return true;
+			}
+			if( stopped() ) {
+				return false;
+			}
+		}
+		return false;
+	}
+
+	bool startPhase2( int depth ) {
+		probes++;
+		cubieCube c = cube;
+		for( int i = 0; i < depth; i++ ) {
+			c.move( moves[i] );
+		}
+		int corner = c.getCornerPerm();
+		int edge = c.getEdgePerm();
+		int slicePerm = c.getSlicePerm();
+		int bound = phase2Bound( corner, edge, slicePerm );
+		for( int togo = bound; togo <= maxLength - depth; togo++ ) {
+			if( phase2( corner, edge, slicePerm, depth, togo ) ) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int phase2Bound( int corner, int edge, int slicePerm ) const {
+		int bound = getNibble( solver.cornerPrune, slicePerm * kociembaSolver::NUM_PERM + corner );
+		int bound2 = getNibble( solver.edgePrune, slicePerm * kociembaSolver::NUM_PERM + edge );
+		return bound > bound2 ? bound : bound2;
+	}
+
+	bool phase2( int corner, int edge, int slicePerm, int depth, int togo ) {
+		if( togo == 0 ) {
+			if( corner || edge || slicePerm ) {
+				return false;
+			}
+			length = depth;
+			return true;
+		}
+		int previous = depth > 0 ? moves[depth - 1] : -1;
+		for( int j = 0; j < kociembaSolver::NUM_PHASE2_MOVES; j++ ) {
+			int m = kociembaSolver::phase2Moves[j];
+			if( !allowedAfter( m, previous ) ) {
+				continue;
+			}
+			int c = solver.cornerMove[corner * kociembaSolver::NUM_PHASE2_MOVES + j];
+			int e = solver.edgeMove[edge * kociembaSolver::NUM_PHASE2_MOVES + j];
+			int s = solver.slicePermMove[slicePerm * kociembaSolver::NUM_PHASE2_MOVES + j];
+			if( phase2Bound( c, e, s ) >= togo ) {
+				continue;
+			}
+			moves[depth] = m;
+			if( phase2( c, e, s, depth + 1, togo - 1 ) ) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	kociembaSearch & operator=( const kociembaSearch & );
+};
+
+int kociembaSolver::solve( const cubieCube & cube, unsigned char * out, int maxLength, long probeLimit,
+	const std::atomic<bool> * cancel ) const {
+	if( !isLoaded() || maxLength > 60 ) {
+		return -1;
+	}
+	kociembaSearch search( *this, cube, maxLength, probeLimit, cancel );
+	return search.run( out );
+}
+
+int kociembaSolver::phase1Distance( int twist, int flip, int slice ) const {
+	if( !isLoaded() ) {
+		return -1;
+	}
+	int bound = getNibble( sliceTwistPrune, slice * NUM_TWIST + twist );
+	int bound2 = getNibble( sliceFlipPrune, slice * NUM_FLIP + flip );
+	for( int depth = bound > bound2 ? bound : bound2; depth <= 20; depth++ ) {
+		if( phase1Reach( twist, flip, slice, depth, -1 ) ) {
+			return depth;
+		}
+	}
+	return -1;
+}
+
+bool kociembaSolver::phase1Reach( int twist, int flip, int slice, int togo, int previous ) const {
+	if( togo == 0 ) {
+		return !twist && !flip && !slice;
+	}
+	for( int m = 0; m < 18; m++ ) {
+		if( !allowedAfter( m, previous ) ) {
+			continue;
+		}
+		int t = twistMove[twist * 18 + m];
+		int f = flipMove[flip * 18 + m];
+		int s = sliceMove[slice * 18 + m];
+		if( getNibble( sliceTwistPrune, s * NUM_TWIST + t ) >= togo
+			|| getNibble( sliceFlipPrune, s * NUM_FLIP + f ) >= togo ) {
+			continue;
+		}
+		if( phase1Reach( t, f, s, togo - 1, m ) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int kociembaSolver::solve( const cubeModel & state, cubeModel::move * out, int maxLength,
+	const std::atomic<bool> * cancel ) const {
+	cubieCube cube;
+	if( !cube.fromModel( state ) ) {
+		return -1;
+	}
+	unsigned char moves[64];
+	int length = solve( cube, moves, maxLength, 0, cancel );
+	for( int i = 0; i < length; i++ ) {
+		out[i] = cubieCube::toMove( moves[i] );
+	}
+	return length;
+}
+
+void kociembaSolver::benchmark( int count, unsigned int seed, int maxLength ) const {
+	unsigned char moves[64];
+	long totalLength = 0;
+	int longest = 0, failed = 0;
+	clock_t start = clock();
+	for( int i = 0; i < count; i++ ) {
+		cubieCube cube;
+		cube.randomize( seed );
+		int length = solve( cube, moves, maxLength );
+		if( length < 0 ) {
+			failed++;
+			continue;
+		}
+		totalLength += length;
+		if( length > longest ) {
+			longest = length;
+		}
+	}
+	double seconds = (double)( clock() - start ) / CLOCKS_PER_SEC;
+	int solved = count - failed;
+	printf( "Two-phase: %d random states in %.3f s, %.1f solves/s, %.3f ms/solve\n",
+		count, seconds, seconds > 0 ? count / seconds : 0.0, count ? seconds * 1000 / count : 0.0 );
+	printf( "  average length %.2f, longest %d, unsolved within %d moves: %d\n",
+		solved ? (double)totalLength / solved : 0.0, longest, maxLength, failed );
+}
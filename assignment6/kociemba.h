@@ -0,0 +1,130 @@
+//Header file for Rubiks cube project
+#ifndef KOCIEMBA_H
+#define KOCIEMBA_H
+#include "cubieCube.h"
+#include "mappedFile.h"
+#include <atomic>
+
+/*
+ * Two-phase solver for the 3x3 cube.
+ *
+ * Phase 1 brings the cube into the subgroup <U, D, R2, L2, F2, B2>
+ * (no twist, no flip, middle layer edges in the middle layer) and phase 2
+ * solves it with those moves.  Each phase is an IDA* search over
+ * coordinates with move tables and 4-bit pruning tables.  Phase 1
+ * solutions of increasing length are tried until phase 2 finishes within
+ * the requested total length.
+ *
+ * The tables (about 4 MB) are generated once and saved to a file.  Later
+ * runs map that file, so startup costs no more than opening it.
+ */
+class kociembaSolver {
+public:
+	/*
+	 * Constructor.  Call load() before solving.
+	 */
+	kociembaSolver();
+
+	/*
+	 * Destructor
+	 */
+	~kociembaSolver();
+
+	/*
+	 * Maps the tables stored at path.  If the file is missing or was
+	 * written by a different version, the tables are generated and saved
+	 * there first.  Returns false if the tables could not be generated.
+	 */
+	bool load( const char * path );
+
+	/*
+	 * Returns whether tables are loaded.
+	 */
+	bool isLoaded() const { return twistMove != NULL; }
+
+	/*
+	 * Finds a solution of at most maxLength moves.  Moves are written to
+	 * out (cubieCube move numbers) which needs room for maxLength moves.
+	 * Returns the number of moves or -1 if no solution was found within
+	 * maxLength moves or probeLimit phase 2 searches (0 = no limit), or
+	 * the search was stopped by setting *cancel from another thread.
+	 */
+	int solve( const cubieCube & cube, unsigned char * out, int maxLength = 21, long probeLimit = 0,
+		const std::atomic<bool> * cancel = NULL ) const;
+
+	/*
+	 * Solves a 3x3 sticker state.  Writes packed moves to out.
+	 * Returns -1 if the state is not a valid 3x3 or no solution was found.
+	 */
+	int solve( const cubeModel & state, cubeModel::move * out, int maxLength = 21,
+		const std::atomic<bool> * cancel = NULL ) const;
+
+	/*
+	 * Exact number of moves needed to bring the phase 1 coordinates to
+	 * the subgroup H = <U, D, R2, L2, F2, B2>, which is the distance of
+	 * the coset of H they stand for.  Found by IDA* with the phase 1
+	 * pruning tables.
+	 */
+	int phase1Distance( int twist, int flip, int slice ) const;
+
+	/*
+	 * Solves count random states and prints solves per second and
+	 * solution lengths to stdout.
+	 */
+	void benchmark( int count, unsigned int seed, int maxLength = 21 ) const;
+
+	enum {
+		NUM_TWIST = 2187,
+		NUM_FLIP = 2048,
+		NUM_SLICE = 495,
+		NUM_PERM = 40320,
+		NUM_SLICE_PERM = 24,
+		NUM_PHASE2_MOVES = 10
+	};
+
+	/*
+	 * Moves allowed in phase 2: U, U2, U', R2, F2, D, D2, D', L2, B2.
+	 */
+	static const int phase2Moves[NUM_PHASE2_MOVES];
+
+private:
+	friend class kociembaSearch;
+
+	mappedFile file;
+	unsigned char * generated;	//Tables built this run, NULL if mapped
+
+	//Move tables, [coordinate][move]
+	const unsigned short * twistMove;
+	const unsigned short * flipMove;
+	const unsigned short * sliceMove;
+	const unsigned short * cornerMove;		//Phase 2 moves only
+	const unsigned short * edgeMove;		//Phase 2 moves only
+	const unsigned short * slicePermMove;	//Phase 2 moves only
+
+	//Pruning tables, 4 bits per entry
+	const unsigned char * sliceTwistPrune;	//slice * NUM_TWIST + twist
+	const unsigned char * sliceFlipPrune;	//slice * NUM_FLIP + flip
+	const unsigned char * cornerPrune;		//slicePerm * NUM_PERM + corner
+	const unsigned char * edgePrune;		//slicePerm * NUM_PERM + edge
+
+	/*
+	 * Whether H can be reached from the coordinates in exactly togo
+	 * moves, none on the face of previous.
+	 */
+	bool phase1Reach( int twist, int flip, int slice, int togo, int previous ) const;
+
+	/*
+	 * Points the table pointers into a buffer in the file layout.
+	 */
+	void setTables( const unsigned char * base );
+
+	/*
+	 * Builds all tables into a buffer in the file layout.
+	 */
+	static unsigned char * generate( size_t & size );
+
+	//Not copyable
+	kociembaSolver( const kociembaSolver & );
+	kociembaSolver & operator=( const kociembaSolver & );
+};
+#endif
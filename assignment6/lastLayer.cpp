@@ -0,0 +1,317 @@
+#include "lastLayer.h"
+#include "kociemba.h"
+#include "moveParser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+//cubieCube move numbers of U turns
+static const int turnU = cubieCube::U * 3;
+static const int turnUPrime = cubieCube::U * 3 + 2;
+
+//Phase 2 searches allowed for each shorter algorithm tried
+static const long shortenProbes = 2000;
+
+//Whole cube turns bringing each face to the top, and back
+static const struct {
+	int face;
+	const char * turn;
+	const char * back;
+} rotations[6] = {
+	{ cubeModel::TOP, "", "" },
+	{ cubeModel::FRONT, "x", "x'" },
+	{ cubeModel::BACK, "x'", "x" },
+	{ cubeModel::RIGHT, "z'", "z" },
+	{ cubeModel::LEFT, "z", "z'" },
+	{ cubeModel::BOTTOM, "x2", "x2" }
+};
+
+//Are the corners and edges below the U layer solved?
+static bool firstLayersSolved( const cubieCube & cube ) {
+	for( int i = 4; i < 8; i++ ) {
+		if( cube.cp[i] != i || cube.co[i] ) {
+			return false;
+		}
+	}
+	for( int i = 4; i < 12; i++ ) {
+		if( cube.ep[i] != i || cube.eo[i] ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static int orientKey( const cubieCube & cube ) {
+	return ( ( cube.co[0] * 3 + cube.co[1] ) * 3 + cube.co[2] ) * 3 + cube.co[3]
+		+ 81 * ( cube.eo[0] | cube.eo[1] << 1 | cube.eo[2] << 2 | cube.eo[3] << 3 );
+}
+
+static int permuteKey( const cubieCube & cube ) {
+	return cubieCube::permIndex( cube.cp, 4 ) * 24 + cubieCube::permIndex( cube.ep, 4 );
+}
+
+static int parity( const unsigned char * perm, int n ) {
+	int odd = 0;
+	for( int i = 0; i < n; i++ ) {
+		for( int j = i + 1; j < n; j++ ) {
+			odd ^= perm[i] > perm[j];
+		}
+	}
+	return odd;
+}
+
+static void appendTurns( std::vector<unsigned char> & moves, int quarters ) {
+	if( quarters % 4 ) {
+		cubieCube::appendMove( moves, turnU + quarters % 4 - 1 );
+	}
+}
+
+//Two-phase solution, shortened while the solver finds shorter ones quickly
+static void findAlgorithm( const kociembaSolver & solver, const cubieCube & cube, std::vector<unsigned char> & out ) {
+	unsigned char moves[32];
+	int length = solver.solve( cube, moves, 24 );
+	out.assign( moves, moves + ( length > 0 ? length : 0 ) );
+	while( length > 0 ) {
+		length = solver.solve( cube, moves, length - 1, shortenProbes );
+		if( length >= 0 ) {
+			out.assign( moves, moves + length );
+		}
+	}
+}
+
+lastLayer::lastLayer() {
+	for( int i = 0; i < ORIENT_PATTERNS; i++ ) {
+		orientTable[i].number = -1;
+	}
+	for( int i = 0; i < PERMUTE_PATTERNS; i++ ) {
+		permuteTable[i].number = -1;
+	}
+}
+
+void lastLayer::build( const kociembaSolver & solver ) {
+	orientAlgs.clear();
+	permuteAlgs.clear();
+
+	//OLL: every orientation with the pieces in place, in all 4 pre-AUFs
+	for( int twists = 0; twists < 81; twists++ ) {
+		for( int flips = 0; flips < 16; flips++ ) {
+			cubieCube cube;
+			int sum = 0, flipped = 0;
+			for( int i = 0, t = twists; i < 4; i++, t /= 3 ) {
+				cube.co[3 - i] = t % 3;
+				sum += t % 3;
+			}
+			for( int i = 0; i < 4; i++ ) {
+				cube.eo[i] = ( flips >> i ) & 1;
+				flipped += cube.eo[i];
+			}
+			if( sum % 3 || flipped % 2 || orientTable[orientKey( cube )].number >= 0 ) {
+				continue;
+			}
+			short number = (short)orientAlgs.size();
+			orientAlgs.push_back( std::vector<unsigned char>() );
+			findAlgorithm( solver, cube, orientAlgs.back() );
+			for( int pre = 0; pre < 4; pre++ ) {
+				entry & e = orientTable[orientKey( cube )];
+				if( e.number < 0 ) {
+					e.number = number;
+					e.preAuf = (unsigned char)pre;
+					e.postAuf = 0;
+				}
+				cube.move( turnUPrime );
+			}
+		}
+	}
+
+	//PLL: every even permutation, in all pre- and post-AUFs
+	unsigned char corners[4], edges[4];
+	for( int c = 0; c < 24; c++ ) {
+		for( int e = 0; e < 24; e++ ) {
+			cubieCube::permFromIndex( c, corners, 4 );
+			cubieCube::permFromIndex( e, edges, 4 );
+			cubieCube perm;
+			memcpy( perm.cp, corners, 4 );
+			memcpy( perm.ep, edges, 4 );
+			if( parity( corners, 4 ) != parity( edges, 4 ) || permuteTable[permuteKey( perm )].number >= 0 ) {
+				continue;
+			}
+			short number = (short)permuteAlgs.size();
+			permuteAlgs.push_back( std::vector<unsigned char>() );
+			findAlgorithm( solver, perm, permuteAlgs.back() );
+
+			//U^-post * perm * U^-pre is solved by U^pre, the algorithm, U^post
+			for( int post = 0; post < 4; post++ ) {
+				for( int pre = 0; pre < 4; pre++ ) {
+					cubieCube cube;
+					for( int k = 0; k < post; k++ ) {
+						cube.move( turnUPrime );
+					}
+					cube.multiply( perm );
+					for( int k = 0; k < pre; k++ ) {
+						cube.move( turnUPrime );
+					}
+					entry & e = permuteTable[permuteKey( cube )];
+					if( e.number < 0 ) {
+						e.number = number;
+						e.preAuf = (unsigned char)pre;
+						e.postAuf = (unsigned char)post;
+					}
+				}
+			}
+		}
+	}
+}
+
+bool lastLayer::recognize( const cubeModel & state, Hint & hint ) const {
+	if( state.getDimensions() != 3 || !isBuilt() ) {
+		return false;
+	}
+	for( int r = 0; r < 6; r++ ) {
+		cubeModel view( state );
+		cubeModel::move turn = 0, back = 0;
+		bool rotated = rotations[r].turn[0] != 0;
+		if( rotated ) {
+			moveParser::parse( rotations[r].turn, (int)strlen( rotations[r].turn ), turn );
+			moveParser::parse( rotations[r].back, (int)strlen( rotations[r].back ), back );
+			view.apply( turn );
+		}
+		cubieCube cube;
+		if( !cube.fromModel( view ) ) {
+			return false;
+		}
+		if( !firstLayersSolved( cube ) ) {
+			continue;
+		}
+		if( cube.isSolved() ) {
+			return false;
+		}
+
+		std::vector<unsigned char> moves;
+		const entry & oriented = orientTable[orientKey( cube )];
+		if( oriented.number > 0 ) {
+			hint.step = OLL;
+			hint.number = oriented.number;
+			appendTurns( moves, oriented.preAuf );
+			for( size_t i = 0; i < orientAlgs[oriented.number].size(); i++ ) {
+				cubieCube::appendMove( moves, orientAlgs[oriented.number][i] );
+			}
+		}
+		else {
+			const entry & permuted = permuteTable[permuteKey( cube )];
+			hint.step = permuted.number > 0 ? PLL : AUF;
+			hint.number = permuted.number;
+			appendTurns( moves, permuted.preAuf );
+			for( size_t i = 0; i < permuteAlgs[permuted.number].size(); i++ ) {
+				cubieCube::appendMove( moves, permuteAlgs[permuted.number][i] );
+			}
+			appendTurns( moves, permuted.postAuf );
+		}
+
+		hint.face = rotations[r].face;
+		hint.moves.clear();
+		if( rotated ) {
+			hint.moves.push_back( turn );
+		}
+		for( size_t i = 0; i < moves.size(); i++ ) {
+			hint.moves.push_back( cubieCube::toMove( moves[i] ) );
+		}
+		if( rotated ) {
+			hint.moves.push_back( back );
+		}
+		return true;
+	}
+	return false;
+}
+
+int lastLayer::getCases( Step step ) const {
+	int cases = step == OLL ? (int)orientAlgs.size() : step == PLL ? (int)permuteAlgs.size() : 1;
+	return cases > 0 ? cases - 1 : 0;
+}
+
+const std::vector<unsigned char> & lastLayer::getAlgorithm( Step step, int number ) const {
+	return step == OLL ? orientAlgs[number] : permuteAlgs[step == PLL ? number : 0];
+}
+
+//Writes cubieCube moves in move notation
+static void printMoves( const std::vector<unsigned char> & moves ) {
+	char text[32];
+	for( size_t i = 0; i < moves.size(); i++ ) {
+		moveParser::format( cubieCube::toMove( moves[i] ), text );
+		printf( " %s", text );
+	}
+	printf( " (%d)\n", (int)moves.size() );
+}
+
+void lastLayer::benchmark( const kociembaSolver & solver, int count, unsigned int seed ) {
+	if( !isBuilt() ) {
+		std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+		build( solver );
+		printf( "Last layer tables built in %.0f ms\n", std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - begin ).count() );
+	}
+	long totalLength = 0;
+	for( int i = 1; i <= getCases( OLL ); i++ ) {
+		printf( "OLL %2d:", i );
+		printMoves( orientAlgs[i] );
+		totalLength += (long)orientAlgs[i].size();
+	}
+	for( int i = 1; i <= getCases( PLL ); i++ ) {
+		printf( "PLL %2d:", i );
+		printMoves( permuteAlgs[i] );
+		totalLength += (long)permuteAlgs[i].size();
+	}
+	printf( "%d OLL and %d PLL cases, average %.1f moves\n", getCases( OLL ), getCases( PLL ),
+		(double)totalLength / ( getCases( OLL ) + getCases( PLL ) ) );
+
+	//Random last layers on random faces
+	std::vector<cubeModel> states;
+	for( int i = 0; i < count; i++ ) {
+		cubieCube cube;
+		do {
+			seed = seed * 1103515245 + 12345;
+			unsigned int r = seed >> 4;
+			cubieCube::permFromIndex( r % 24, cube.cp, 4 );
+			cubieCube::permFromIndex( r / 24 % 24, cube.ep, 4 );
+		} while( parity( cube.cp, 4 ) != parity( cube.ep, 4 ) );
+		seed = seed * 1103515245 + 12345;
+		unsigned int r = seed >> 4;
+		cube.co[0] = r % 3;
+		cube.co[1] = r / 3 % 3;
+		cube.co[2] = r / 9 % 3;
+		cube.co[3] = ( 6 - cube.co[0] - cube.co[1] - cube.co[2] ) % 3;
+		cube.eo[0] = r >> 5 & 1;
+		cube.eo[1] = r >> 6 & 1;
+		cube.eo[2] = r >> 7 & 1;
+		cube.eo[3] = ( cube.eo[0] + cube.eo[1] + cube.eo[2] ) & 1;
+		cubeModel state( 3 );
+		cube.toModel( state );
+		const char * turn = rotations[( r >> 8 ) % 6].turn;
+		cubeModel::move m;
+		if( turn[0] && moveParser::parse( turn, (int)strlen( turn ), m ) ) {
+			state.apply( m );
+		}
+		states.push_back( state );
+	}
+
+	Hint hint;
+	std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+	for( int i = 0; i < count; i++ ) {
+		recognize( states[i], hint );
+	}
+	double micros = std::chrono::duration<double, std::micro>(
+		std::chrono::high_resolution_clock::now() - begin ).count();
+
+	int failed = 0;
+	for( int i = 0; i < count; i++ ) {
+		int steps = 0;
+		while( steps < 3 && recognize( states[i], hint ) ) {
+			states[i].apply( &hint.moves[0], (int)hint.moves.size() );
+			steps++;
+		}
+		if( !states[i].isSolved() ) {
+			failed++;
+		}
+	}
+	printf( "Recognized %d random last layers, %.2f us each, not solved by the hints: %d\n",
+		count, count ? micros / count : 0.0, failed );
+}
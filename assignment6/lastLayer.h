@@ -0,0 +1,112 @@
+//Header file for Rubiks cube project
+#ifndef LASTLAYER_H
+#define LASTLAYER_H
+#include "cubeModel.h"
+#include <vector>
+
+class kociembaSolver;
+
+/*
+ * Recognition of 3x3 last layer cases for hints, in two looks: OLL
+ * orients the last layer, then PLL permutes it.
+ *
+ * Every case has one algorithm, found by the two-phase solver (shortened
+ * as far as a small search allows) for a representative state.  Each
+ * case is stored under every pattern it shows after a turn of the last
+ * layer (pre-AUF, "adjust U face"), and a PLL also under every turn
+ * needed after it (post-AUF), so a pattern is looked up directly:
+ *	- OLL pattern: twist of the 4 last layer corners and flip of the 4
+ *	  edges, 81 * 16 entries
+ *	- PLL pattern: permutation of the 4 corners and of the 4 edges,
+ *	  24 * 24 entries
+ * The OLL algorithm keeps the first two layers whatever the permutation
+ * of the last layer, since a pure permutation of its pieces changes no
+ * orientations.
+ *
+ * The last layer may be any face: the cube is turned whole so that each
+ * face in turn is on top and the first face whose opposite two layers
+ * are solved is used.
+ */
+class lastLayer {
+public:
+	enum Step {
+		OLL,	//Orient the last layer
+		PLL,	//Permute the oriented last layer
+		AUF		//Only the last layer needs turning
+	};
+
+	/*
+	 * Hint for one step.  moves turns the cube so the last layer is on
+	 * top (if it is not), does the step and turns the cube back.
+	 */
+	struct Hint {
+		Step step;
+		int number;		//Case number within the step, from 1
+		int face;		//cubeModel face of the last layer
+		std::vector<cubeModel::move> moves;
+	};
+
+	/*
+	 * Constructor.  Call build() before recognize().
+	 */
+	lastLayer();
+
+	/*
+	 * Finds the algorithms of every case and fills the pattern tables.
+	 * The solver must be loaded.  Takes about a second.
+	 */
+	void build( const kociembaSolver & solver );
+
+	/*
+	 * Returns whether build() has been called.
+	 */
+	bool isBuilt() const { return !orientAlgs.empty(); }
+
+	/*
+	 * Finds the hint for the next step of a 3x3 sticker state.  Returns
+	 * false if the cube is solved, is not a valid 3x3 or has no face with
+	 * the two layers below it solved.
+	 */
+	bool recognize( const cubeModel & state, Hint & hint ) const;
+
+	/*
+	 * Number of cases of a step, without the solved one.
+	 */
+	int getCases( Step step ) const;
+
+	/*
+	 * Algorithm of a case as cubieCube move numbers.
+	 */
+	const std::vector<unsigned char> & getAlgorithm( Step step, int number ) const;
+
+	/*
+	 * Builds the tables if needed, prints every case and then recognizes
+	 * count random last layers, checking that the hints solve them.
+	 */
+	void benchmark( const kociembaSolver & solver, int count, unsigned int seed );
+
+	enum {
+		ORIENT_PATTERNS = 81 * 16,
+		PERMUTE_PATTERNS = 24 * 24
+	};
+
+private:
+	//Case of a pattern and the turns of the last layer around it
+	struct entry {
+		short number;	//-1 for patterns of no case
+		unsigned char preAuf;
+		unsigned char postAuf;
+	};
+
+	entry orientTable[ORIENT_PATTERNS];
+	entry permuteTable[PERMUTE_PATTERNS];
+
+	//Algorithms by case number, solved case first
+	std::vector<std::vector<unsigned char> > orientAlgs;
+	std::vector<std::vector<unsigned char> > permuteAlgs;
+
+	//Not copyable
+	lastLayer( const lastLayer & );
+	lastLayer & operator=( const lastLayer & );
+};
+#endif
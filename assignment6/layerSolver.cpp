@@ -0,0 +1,348 @@
+#include "layerSolver.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+//Opposite face and the face to the right, looking at a side face
+static const int opposite[6] = { cubieCube::D, cubieCube::L, cubieCube::B, cubieCube::U, cubieCube::R, cubieCube::F };
+static const int rightOf[6] = { -1, cubieCube::B, cubieCube::R, -1, cubieCube::F, cubieCube::L };
+
+/*
+ * The first two layers in solving order: 4 D edges, 4 D corners and 4
+ * middle edges, each solved looking at one side face (front), with the
+ * piece's slot at the front right for corners and middle edges.
+ */
+static const int fronts[4] = { cubieCube::F, cubieCube::R, cubieCube::B, cubieCube::L };
+static const int crossEdges[4] = { 5, 4, 7, 6 };	//DF DR DB DL
+static const int bottomCorners[4] = { 4, 7, 6, 5 };	//DFR DRB DBL DLF
+static const int middleEdges[4] = { 8, 11, 10, 9 };	//FR BR BL FL
+
+//Front looking at each edge and corner slot below the U layer
+static const int edgeFront[12] = { -1, -1, -1, -1, cubieCube::R, cubieCube::F, cubieCube::L, cubieCube::B,
+	cubieCube::F, cubieCube::L, cubieCube::B, cubieCube::R };
+static const int cornerFront[8] = { -1, -1, -1, -1, cubieCube::F, cubieCube::L, cubieCube::B, cubieCube::R };
+
+//Algorithms, with F and R standing for the front and its right
+static const char * const crossAlgs[] = { "F2", "U' R' F R", "U L F' L'" };
+static const char * const cornerTrigger = "R U R' U'";
+static const char * const middleAlgs[] = { "U R U' R' U' F' U F", "U' F' U F U R U' R'" };
+static const char * const orientEdgeAlgs[] = { "F R U R' U' F'", "F U R U' R' F'" };
+static const char * const permuteEdgeAlgs[] = { "R U R' U R U2 R'" };
+static const char * const permuteCornerAlgs[] = { "U R U' L' U R' U' L", "L' U R U' L U R' U'" };
+static const char * const twistCorner = "R' D' R D";
+
+static void turnTop( cubieCube & cube, int quarters, std::vector<unsigned char> & moves ) {
+	if( quarters & 3 ) {
+		int m = cubieCube::U * 3 + ( quarters & 3 ) - 1;
+		cube.move( m );
+		cubieCube::appendMove( moves, m );
+	}
+}
+
+//Applies an algorithm seen from front
+static void applyAlg( cubieCube & cube, const char * alg, int front, std::vector<unsigned char> & moves ) {
+	for( const char * c = alg; *c; c++ ) {
+		int face;
+		switch( *c ) {
+			case 'U': face = cubieCube::U; break;
+			case 'D': face = cubieCube::D; break;
+			case 'F': face = front; break;
+			case 'B': face = opposite[front]; break;
+			case 'R': face = rightOf[front]; break;
+			case 'L': face = opposite[rightOf[front]]; break;
+			default: continue;
+		}
+		int quarters = 1;
+		if( c[1] == '2' ) {
+			quarters = 2;
+			c++;
+		}
+		else if( c[1] == '\'' ) {
+			quarters = 3;
+			c++;
+		}
+		cube.move( face * 3 + quarters - 1 );
+		cubieCube::appendMove( moves, face * 3 + quarters - 1 );
+	}
+}
+
+static bool edgeSolved( const cubieCube & cube, int e ) {
+	return cube.ep[e] == e && cube.eo[e] == 0;
+}
+
+static bool cornerSolved( const cubieCube & cube, int c ) {
+	return cube.cp[c] == c && cube.co[c] == 0;
+}
+
+//Are the first count pieces of the first two layers solved?
+static bool firstPiecesSolved( const cubieCube & cube, int count ) {
+	for( int k = 0; k < count; k++ ) {
+		int stage = k / 4, i = k % 4;
+		bool solved = stage == 0 ? edgeSolved( cube, crossEdges[i] )
+			: stage == 1 ? cornerSolved( cube, bottomCorners[i] ) : edgeSolved( cube, middleEdges[i] );
+		if( !solved ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static int findEdge( const cubieCube & cube, int e ) {
+	for( int i = 0; i < 12; i++ ) {
+		if( cube.ep[i] == e ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int findCorner( const cubieCube & cube, int c ) {
+	for( int i = 0; i < 8; i++ ) {
+		if( cube.cp[i] == c ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Solves piece k of the first two layers: takes it out of a wrong slot,
+ * then keeps the shortest U turn and algorithm that solves it and the
+ * pieces before it.
+ */
+static bool solvePiece( const cubieCube & cube, int k, std::vector<unsigned char> & moves ) {
+	int stage = k / 4, front = fronts[k % 4];
+	cubieCube start = cube;
+	std::vector<unsigned char> prefix;
+	std::vector<const char *> algs;
+	std::vector<std::string> repeats;
+	if( stage == 0 ) {
+		int p = findEdge( start, crossEdges[k % 4] );
+		if( p >= 4 && p < 8 ) {
+			applyAlg( start, "F2", edgeFront[p], prefix );
+		}
+		else if( p >= 8 ) {
+			applyAlg( start, "R U R'", edgeFront[p], prefix );
+		}
+		algs.assign( crossAlgs, crossAlgs + 3 );
+	}
+	else if( stage == 1 ) {
+		int p = findCorner( start, bottomCorners[k % 4] );
+		if( p >= 4 && p != bottomCorners[k % 4] ) {
+			applyAlg( start, cornerTrigger, cornerFront[p], prefix );
+		}
+		//The trigger repeated up to 5 times twists the corner into place
+		std::string alg;
+		for( int r = 0; r < 5; r++ ) {
+			alg += r ? " " : "";
+			alg += cornerTrigger;
+			repeats.push_back( alg );
+		}
+		for( int r = 0; r < 5; r++ ) {
+			algs.push_back( repeats[r].c_str() );
+		}
+	}
+	else {
+		int p = findEdge( start, middleEdges[k % 4] );
+		if( p >= 8 ) {
+			applyAlg( start, middleAlgs[0], edgeFront[p], prefix );
+		}
+		algs.assign( middleAlgs, middleAlgs + 2 );
+	}
+
+	std::vector<unsigned char> best, trial;
+	bool found = false;
+	for( int quarters = 0; quarters < 4; quarters++ ) {
+		for( size_t a = 0; a < algs.size(); a++ ) {
+			cubieCube next = start;
+			trial = prefix;
+			turnTop( next, quarters, trial );
+			applyAlg( next, algs[a], front, trial );
+			if( firstPiecesSolved( next, k + 1 ) && ( !found || trial.size() < best.size() ) ) {
+				best = trial;
+				found = true;
+			}
+		}
+	}
+	moves = best;
+	return found;
+}
+
+typedef bool (*goalFunc)( const cubieCube & cube );
+
+static bool edgesOriented( const cubieCube & cube ) {
+	return firstPiecesSolved( cube, 12 ) && !cube.eo[0] && !cube.eo[1] && !cube.eo[2] && !cube.eo[3];
+}
+
+static bool edgesPlaced( const cubieCube & cube ) {
+	return edgesOriented( cube ) && cube.ep[0] == 0 && cube.ep[1] == 1 && cube.ep[2] == 2 && cube.ep[3] == 3;
+}
+
+static bool cornersPlaced( const cubieCube & cube ) {
+	return edgesPlaced( cube ) && cube.cp[0] == 0 && cube.cp[1] == 1 && cube.cp[2] == 2 && cube.cp[3] == 3;
+}
+
+/*
+ * Tries sequences of depth algorithms, each after a U turn, followed by
+ * a U turn if finalTurn is set, and keeps the shortest that reaches goal.
+ */
+static void searchAlgs( const cubieCube & cube, const char * const * algs, int numAlgs, int depth, bool finalTurn,
+	goalFunc goal, std::vector<unsigned char> & moves, std::vector<unsigned char> & best, bool & found ) {
+	if( depth == 0 ) {
+		for( int quarters = 0; quarters < ( finalTurn ? 4 : 1 ); quarters++ ) {
+			cubieCube next = cube;
+			std::vector<unsigned char> trial = moves;
+			turnTop( next, quarters, trial );
+			if( goal( next ) && ( !found || trial.size() < best.size() ) ) {
+				best = trial;
+				found = true;
+			}
+		}
+		return;
+	}
+	for( int quarters = 0; quarters < 4; quarters++ ) {
+		for( int a = 0; a < numAlgs; a++ ) {
+			//Copied back, since merging turns can change the last move
+			cubieCube next = cube;
+			std::vector<unsigned char> saved = moves;
+			turnTop( next, quarters, moves );
+			applyAlg( next, algs[a], cubieCube::F, moves );
+			searchAlgs( next, algs, numAlgs, depth - 1, finalTurn, goal, moves, best, found );
+			moves = saved;
+		}
+	}
+}
+
+static bool lastLayerStep( const cubieCube & cube, const char * const * algs, int numAlgs, bool finalTurn,
+	goalFunc goal, std::vector<unsigned char> & moves ) {
+	std::vector<unsigned char> trial, best;
+	bool found = false;
+	for( int depth = 0; depth <= 3 && !found; depth++ ) {
+		searchAlgs( cube, algs, numAlgs, depth, finalTurn, goal, trial, best, found );
+	}
+	moves = best;
+	return found;
+}
+
+layerSolver::Stage layerSolver::nextStep( const cubieCube & cube, std::vector<unsigned char> & moves ) {
+	moves.clear();
+	for( int k = 0; k < 12; k++ ) {
+		if( !firstPiecesSolved( cube, k + 1 ) ) {
+			solvePiece( cube, k, moves );
+			return (Stage)( k / 4 );
+		}
+	}
+	if( !edgesOriented( cube ) ) {
+		lastLayerStep( cube, orientEdgeAlgs, 2, false, edgesOriented, moves );
+		return ORIENT_EDGES;
+	}
+	for( int quarters = 1; quarters < 4; quarters++ ) {
+		cubieCube next = cube;
+		turnTop( next, quarters, moves );
+		if( next.isSolved() ) {
+			return ALIGN;
+		}
+		moves.clear();
+	}
+	if( !edgesPlaced( cube ) ) {
+		lastLayerStep( cube, permuteEdgeAlgs, 1, true, edgesPlaced, moves );
+		return PERMUTE_EDGES;
+	}
+	if( !cornersPlaced( cube ) ) {
+		lastLayerStep( cube, permuteCornerAlgs, 2, true, cornersPlaced, moves );
+		return PERMUTE_CORNERS;
+	}
+	if( !cube.isSolved() ) {
+		//Twist each corner at URF with the D layer until it faces up,
+		//which leaves the D layer solved once all are done
+		cubieCube next = cube;
+		for( int i = 0; i < 4; i++ ) {
+			//Twice twists it in place, once would swap it out
+			while( next.co[0] ) {
+				applyAlg( next, twistCorner, cubieCube::F, moves );
+				applyAlg( next, twistCorner, cubieCube::F, moves );
+			}
+			turnTop( next, 1, moves );
+		}
+		return ORIENT_CORNERS;
+	}
+	return SOLVED;
+}
+
+bool layerSolver::nextStep( const cubeModel & state, std::vector<cubeModel::move> & moves, Stage & stage ) {
+	cubieCube cube;
+	if( !cube.fromModel( state ) ) {
+		return false;
+	}
+	std::vector<unsigned char> steps;
+	stage = nextStep( cube, steps );
+	moves.resize( steps.size() );
+	for( size_t i = 0; i < steps.size(); i++ ) {
+		moves[i] = cubieCube::toMove( steps[i] );
+	}
+	return true;
+}
+
+int layerSolver::solve( const cubieCube & cube, std::vector<unsigned char> & moves ) {
+	cubieCube next = cube;
+	std::vector<unsigned char> step;
+	moves.clear();
+	for( int i = 0; i < 32 && nextStep( next, step ) != SOLVED; i++ ) {
+		for( size_t k = 0; k < step.size(); k++ ) {
+			next.move( step[k] );
+			moves.push_back( step[k] );
+		}
+	}
+	return (int)moves.size();
+}
+
+const char * layerSolver::stageName( Stage stage ) {
+	switch( stage ) {
+		case CROSS: return "cross";
+		case CORNERS: return "first layer corners";
+		case MIDDLE: return "middle layer";
+		case ORIENT_EDGES: return "last layer edge orientation";
+		case PERMUTE_EDGES: return "last layer edge permutation";
+		case PERMUTE_CORNERS: return "last layer corner permutation";
+		case ORIENT_CORNERS: return "last layer corner orientation";
+		case ALIGN: return "last layer turn";
+		default: return "solved";
+	}
+}
+
+void layerSolver::benchmark( int count, unsigned int seed ) {
+	std::vector<unsigned char> step;
+	long totalLength = 0, steps = 0;
+	int longest = 0, failed = 0;
+	double totalMicros = 0, slowest = 0;
+	for( int i = 0; i < count; i++ ) {
+		cubieCube cube;
+		cube.randomize( seed );
+		int length = 0, s;
+		for( s = 0; s < 32; s++ ) {
+			std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+			Stage stage = nextStep( cube, step );
+			double micros = std::chrono::duration<double, std::micro>(
+				std::chrono::high_resolution_clock::now() - begin ).count();
+			totalMicros += micros;
+			slowest = micros > slowest ? micros : slowest;
+			steps++;
+			if( stage == SOLVED ) {
+				break;
+			}
+			for( size_t k = 0; k < step.size(); k++ ) {
+				cube.move( step[k] );
+			}
+			length += (int)step.size();
+		}
+		if( !cube.isSolved() ) {
+			failed++;
+		}
+		totalLength += length;
+		longest = length > longest ? length : longest;
+	}
+	printf( "Layer by layer: %d random states, %.2f us per step (slowest %.0f us), %.1f steps per solve\n",
+		count, steps ? totalMicros / steps : 0.0, slowest, count ? (double)steps / count : 0.0 );
+	printf( "  average length %.1f, longest %d, not solved: %d\n",
+		count ? (double)totalLength / count : 0.0, longest, failed );
+}
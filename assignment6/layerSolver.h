@@ -0,0 +1,64 @@
+//Header file for Rubiks cube project
+#ifndef LAYERSOLVER_H
+#define LAYERSOLVER_H
+#include "cubieCube.h"
+#include <vector>
+
+/*
+ * Layer-by-layer 3x3 solver for hints, the way a beginner solves the
+ * cube: the D cross, the D corners, the middle layer edges, then the U
+ * layer with a few fixed algorithms.
+ *
+ * Each call returns only the moves of the next step (one piece of the
+ * first two layers, or one last layer algorithm), so a hint costs a few
+ * microseconds.  Nothing is precomputed: a piece is first taken out of a
+ * wrong slot into the U layer, then each U turn is tried with each of
+ * the step's algorithms (turned to face the slot) until one solves the
+ * piece without breaking what was solved before.  Last layer steps try
+ * up to two algorithms, each after any U turn.  The result only depends
+ * on the state, so repeated hints follow one solution.
+ */
+class layerSolver {
+public:
+	enum Stage {
+		CROSS,				//D edges
+		CORNERS,			//D corners
+		MIDDLE,				//Middle layer edges
+		ORIENT_EDGES,		//U edges facing up
+		PERMUTE_EDGES,		//U edges in place
+		PERMUTE_CORNERS,	//U corners in place
+		ORIENT_CORNERS,		//U corners facing up
+		ALIGN,				//Turn U to finish
+		SOLVED
+	};
+
+	/*
+	 * Writes the moves of the next step (cubieCube move numbers) to
+	 * moves and returns its stage.  Returns SOLVED with no moves for the
+	 * solved cube.
+	 */
+	static Stage nextStep( const cubieCube & cube, std::vector<unsigned char> & moves );
+
+	/*
+	 * Next step for a 3x3 sticker state, as packed moves.  Returns false
+	 * if the state is not a valid 3x3.
+	 */
+	static bool nextStep( const cubeModel & state, std::vector<cubeModel::move> & moves, Stage & stage );
+
+	/*
+	 * Whole solution: every step until solved.  Returns its length.
+	 */
+	static int solve( const cubieCube & cube, std::vector<unsigned char> & moves );
+
+	/*
+	 * Name of a stage for messages.
+	 */
+	static const char * stageName( Stage stage );
+
+	/*
+	 * Solves count random states step by step and prints the time per
+	 * step and the solution lengths.
+	 */
+	static void benchmark( int count, unsigned int seed );
+};
+#endif
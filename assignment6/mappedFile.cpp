@@ -0,0 +1,113 @@
+#include "mappedFile.h"
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mappedFile::mappedFile() {
+	data = NULL;
+	size = 0;
+#ifdef _WIN32
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+#endif
+}
+
+mappedFile::~mappedFile() {
+	close();
+}
+
+bool mappedFile::open( const char * path ) {
+	close();
+#ifdef _WIN32
+	file = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE ) {
+		return false;
+	}
+	LARGE_INTEGER length;
+	if( !GetFileSizeEx( file, &length ) || length.QuadPart == 0 ) {
+		close();
+		return false;
+	}
+	mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( mapping == NULL ) {
+		close();
+		return false;
+	}
+	data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	if( data == NULL ) {
+		close();
+		return false;
+	}
+	size = (size_t)length.QuadPart;
+#else
+	int fd = ::open( path, O_RDONLY );
+	if( fd < 0 ) {
+		return false;
+	}
+	struct stat info;
+	if( fstat( fd, &info ) != 0 || info.st_size == 0 ) {
+		::close( fd );
+		return false;
+	}
+	void * map = mmap( NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	::close( fd );
+	if( map == MAP_FAILED ) {
+		return false;
+	}
+	data = map;
+	size = info.st_size;
+#endif
+	return true;
+}
+
+void mappedFile::close() {
+#ifdef _WIN32
+	if( data ) {
+		UnmapViewOfFile( data );
+	}
+	if( mapping ) {
+		CloseHandle( mapping );
+	}
+	if( file != INVALID_HANDLE_VALUE ) {
+		CloseHandle( file );
+	}
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+#else
+	if( data ) {
+		munmap( (void *)data, size );
+	}
+#endif
+	data = NULL;
+	size = 0;
+}
+
+bool mappedFile::write( const char * path, const void * data, size_t size ) {
+	std::string temp = std::string( path ) + ".tmp";
+	FILE * out = fopen( temp.c_str(), "wb" );
+	if( !out ) {
+		return false;
+	}
+	bool ok = fwrite( data, 1, size, out ) == size;
+	ok = ( fclose( out ) == 0 ) && ok;
+	if( ok ) {
+#ifdef _WIN32
+		ok = MoveFileExA( temp.c_str(), path, MOVEFILE_REPLACE_EXISTING ) != 0;
+#else
+		ok = rename( temp.c_str(), path ) == 0;
+#endif
+	}
+	if( !ok ) {
+		remove( temp.c_str() );
+	}
+	return ok;
+}
@@ -0,0 +1,62 @@
+//Header file for Rubiks cube project
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <cstddef>
+
+/*
+ * Read-only memory mapping of a whole file.  Used to load solver tables
+ * without reading them: pages are brought in by the OS on first use and
+ * shared between processes mapping the same file.
+ */
+class mappedFile {
+public:
+	/*
+	 * Constructor
+	 */
+	mappedFile();
+
+	/*
+	 * Destructor.  Unmaps the file.
+	 */
+	~mappedFile();
+
+	/*
+	 * Maps a file.  Returns false if it can not be opened.
+	 */
+	bool open( const char * path );
+
+	/*
+	 * Unmaps the file.
+	 */
+	void close();
+
+	/*
+	 * Start of the mapped data, NULL if nothing is mapped.
+	 */
+	const void * getData() const { return data; }
+
+	/*
+	 * Size of the mapped data in bytes.
+	 */
+	size_t getSize() const { return size; }
+
+	/*
+	 * Writes a buffer to a file, replacing it.  The data is written to a
+	 * temporary file first and renamed, so a reader never maps a partly
+	 * written file.  Returns false on failure.
+	 */
+	static bool write( const char * path, const void * data, size_t size );
+
+private:
+	const void * data;
+	size_t size;
+#ifdef _WIN32
+	void * file;
+	void * mapping;
+#endif
+
+	//Not copyable
+	mappedFile( const mappedFile & );
+	mappedFile & operator=( const mappedFile & );
+};
+#endif
@@ -0,0 +1,250 @@
+#include "moveParser.h"
+
+//Characters that can appear inside a move token.  Bytes >= 0x80 are let
+//through so a UTF-8 right quote can be used as a prime.
+static bool isTokenChar( unsigned char c ) {
+	return ( c >= '0' && c <= '9' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= 'a' && c <= 'z' )
+		|| c == '\'' || c == '-' || c >= 0x80;
+}
+
+moveParser::moveParser( FILE * input ) {
+	in = input;
+	buffer = new char[BUFFER_SIZE];
+	size = 0;
+	pos = 0;
+	tokenLength = 0;
+	comment = false;
+	line = 1;
+	errors = 0;
+	errorLine = 0;
+}
+
+moveParser::~moveParser() {
+	delete [] buffer;
+}
+
+int moveParser::next( cubeModel::move * moves, int capacity ) {
+	int count = 0;
+	while( count < capacity ) {
+		if( pos == size ) {
+			size = in ? (int)fread( buffer, 1, BUFFER_SIZE, in ) : 0;
+			pos = 0;
+			if( size == 0 ) {
+				//End of input, flush the last token
+				if( tokenLength && finishToken( moves[count] ) ) {
+					count++;
+				}
+				tokenLength = 0;
+				break;
+			}
+		}
+
+		unsigned char c = buffer[pos++];
+		if( c == '\n' ) {
+			line++;
+			comment = false;
+		}
+		if( comment ) {
+			continue;
+		}
+		if( isTokenChar( c ) ) {
+			if( tokenLength <= MAX_TOKEN ) {
+				token[tokenLength] = c;
+			}
+			tokenLength++;
+			continue;
+		}
+		if( c == '#' ) {
+			comment = true;
+		}
+		if( tokenLength && finishToken( moves[count] ) ) {
+			count++;
+		}
+		tokenLength = 0;
+	}
+	return count;
+}
+
+bool moveParser::finishToken( cubeModel::move & out ) {
+	if( tokenLength <= MAX_TOKEN && parse( token, tokenLength, out ) ) {
+		return true;
+	}
+	if( errors == 0 ) {
+		errorLine = line;
+	}
+	errors++;
+	return false;
+}
+
+//Reads a positive number.  Returns -1 if there is none.
+static int readNumber( const char * token, int length, int & i ) {
+	if( i >= length || token[i] < '0' || token[i] > '9' ) {
+		return -1;
+	}
+	int value = 0;
+	while( i < length && token[i] >= '0' && token[i] <= '9' ) {
+		value = value * 10 + ( token[i] - '0' );
+		if( value > cubeModel::INNER_LAYERS ) {
+			return -1;
+		}
+		i++;
+	}
+	return value;
+}
+
+bool moveParser::parse( const char * token, int length, cubeModel::move & out ) {
+	int i = 0;
+
+	//Layer prefix: "3" or "2-4"
+	int from = readNumber( token, length, i );
+	int to = from;
+	if( from >= 0 && i < length && token[i] == '-' ) {
+		i++;
+		to = readNumber( token, length, i );
+		if( to < from ) {
+			return false;
+		}
+	}
+	if( from == 0 || i >= length ) {
+		return false;
+	}
+
+	int face;
+	int first = 0;
+	int last = 0;
+	bool wide = false;
+	char letter = token[i++];
+	switch( letter ) {
+		case 'F': case 'f': face = cubeModel::FRONT; break;
+		case 'B': case 'b': face = cubeModel::BACK; break;
+		case 'U': case 'u': face = cubeModel::TOP; break;
+		case 'D': case 'd': face = cubeModel::BOTTOM; break;
+		case 'R': case 'r': face = cubeModel::RIGHT; break;
+		case 'L': case 'l': face = cubeModel::LEFT; break;
+		case 'M': face = cubeModel::LEFT; first = 1; last = cubeModel::INNER_LAYERS; break;
+		case 'E': face = cubeModel::BOTTOM; first = 1; last = cubeModel::INNER_LAYERS; break;
+		case 'S': face = cubeModel::FRONT; first = 1; last = cubeModel::INNER_LAYERS; break;
+		case 'x': face = cubeModel::RIGHT; last = cubeModel::ALL_LAYERS; break;
+		case 'y': face = cubeModel::TOP; last = cubeModel::ALL_LAYERS; break;
+		case 'z': face = cubeModel::FRONT; last = cubeModel::ALL_LAYERS; break;
+		default:
+			return false;
+	}
+	bool slice = ( last != 0 );
+	if( letter >= 'a' && letter <= 'z' && !slice ) {
+		wide = true;
+	}
+	else if( i < length && token[i] == 'w' && !slice ) {
+		wide = true;
+		i++;
+	}
+	if( slice && from > 0 ) {
+		return false;
+	}
+
+	if( !slice ) {
+		if( wide ) {
+			//Rw is two layers, 3Rw three, 2-4Rw layers two to four
+			first = ( from > 0 && to != from ) ? from - 1 : 0;
+			last = from > 0 ? to - 1 : 1;
+		}
+		else if( from > 0 ) {
+			first = from - 1;
+			last = to - 1;
+		}
+	}
+
+	//Amount and prime, R0 and R4 are not moves
+	int quarters = 1;
+	int amount = readNumber( token, length, i );
+	if( amount == 0 || amount > 3 ) {
+		return false;
+	}
+	if( amount > 0 ) {
+		quarters = amount;
+	}
+	if( i < length && token[i] == '\'' ) {
+		quarters = -quarters;
+		i++;
+	}
+	else if( i + 3 <= length && (unsigned char)token[i] == 0xE2
+		&& (unsigned char)token[i + 1] == 0x80 && (unsigned char)token[i + 2] == 0x99 ) {
+			quarters = -quarters;
+			i += 3;
+	}
+	if( i != length ) {
+		return false;
+	}
+
+	out = cubeModel::makeMove( face, ( ( quarters % 4 ) + 4 ) % 4, first, last );
+	return true;
+}
+
+int moveParser::format( cubeModel::move m, char * out ) {
+	static const char faceNames[] = "FBUDRL";
+	static const char rotationNames[] = "zzyyxx";
+	static const char sliceNames[] = "SSEEMM";
+	int face = cubeModel::moveFace( m );
+	int first = cubeModel::moveFirst( m );
+	int last = cubeModel::moveLast( m );
+	int quarters = cubeModel::moveQuarters( m );
+	int length = 0;
+
+	//Rotations and slices are named after one face of each pair; moves
+	//named after the other face of the pair turn the opposite way.
+	if( first == 0 && last == cubeModel::ALL_LAYERS ) {
+		out[length++] = rotationNames[face];
+		if( face & 1 ) {
+			quarters = 4 - quarters;
+		}
+	}
+	else if( first == 1 && last == cubeModel::INNER_LAYERS ) {
+		out[length++] = sliceNames[face];
+		if( face != cubeModel::LEFT && face != cubeModel::BOTTOM && face != cubeModel::FRONT ) {
+			quarters = 4 - quarters;
+		}
+	}
+	else {
+		if( first == 0 && last == 1 ) {
+			length += sprintf( out + length, "%cw", faceNames[face] );
+		}
+		else if( first == 0 && last > 0 ) {
+			length += sprintf( out + length, "%d%cw", last + 1, faceNames[face] );
+		}
+		else if( first == last && first > 0 ) {
+			length += sprintf( out + length, "%d%c", first + 1, faceNames[face] );
+		}
+		else if( first == last ) {
+			out[length++] = faceNames[face];
+		}
+		else {
+			length += sprintf( out + length, "%d-%d%c", first + 1, last + 1, faceNames[face] );
+		}
+	}
+
+	quarters &= 3;
+	if( quarters == 2 ) {
+		out[length++] = '2';
+	}
+	else if( quarters == 3 ) {
+		out[length++] = '\'';
+	}
+	else if( quarters == 0 ) {
+		out[length++] = '0';
+	}
+	out[length] = '\0';
+	return length;
+}
+
+long moveParser::replay( FILE * input, cubeModel & state ) {
+	enum { BATCH = 4096 };
+	cubeModel::move batch[BATCH];
+	moveParser parser( input );
+	long total = 0;
+	int count;
+	while( ( count = parser.next( batch, BATCH ) ) > 0 ) {
+		state.apply( batch, count );
+		total += count;
+	}
+	return total;
+}
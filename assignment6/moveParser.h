@@ -0,0 +1,90 @@
+//Header file for Rubiks cube project
+#ifndef MOVEPARSER_H
+#define MOVEPARSER_H
+#include <cstdio>
+#include "cubeModel.h"
+
+/*
+ * Streaming parser for cube move notation.  Reads from a FILE in fixed
+ * size chunks and converts moves to packed cubeModel::move codes, so
+ * inputs of any size are parsed with constant memory.
+ *
+ * Supported notation (moves separated by whitespace, commas or brackets,
+ * '#' starts a comment running to the end of the line):
+ *	F B U D R L		outer layer, clockwise looking at the face
+ *	Rw  r			outer two layers
+ *	3Rw				outer three layers
+ *	3R				third layer only
+ *	2-4Rw  2-4R		layers two through four
+ *	M E S			all inner layers, turning like L, D and F
+ *	x y z			whole cube, turning like R, U and F
+ * followed by an optional count of 1 to 3 (R2, R3) and/or a prime (R',
+ * R2').
+ */
+class moveParser {
+public:
+	/*
+	 * Creates a parser reading from input.  Does not take ownership.
+	 */
+	moveParser( FILE * input );
+
+	/*
+	 * Destructor
+	 */
+	~moveParser();
+
+	/*
+	 * Parses up to capacity moves into moves.  Returns how many were
+	 * written, 0 once the input is exhausted.
+	 */
+	int next( cubeModel::move * moves, int capacity );
+
+	/*
+	 * Number of tokens that could not be parsed so far.
+	 */
+	int getErrors() const { return errors; }
+
+	/*
+	 * Line of the first token that could not be parsed, 0 if none.
+	 */
+	long getErrorLine() const { return errorLine; }
+
+	/*
+	 * Parses a single move token.  Returns false if it is not a move,
+	 * which includes a count outside 1 to 3 (R0, R4).
+	 */
+	static bool parse( const char * token, int length, cubeModel::move & out );
+
+	/*
+	 * Writes a move in the notation above.  out needs room for 32 chars.
+	 * Returns the length written.
+	 */
+	static int format( cubeModel::move m, char * out );
+
+	/*
+	 * Parses a whole stream and applies it to state in batches.
+	 * Returns the number of moves applied.
+	 */
+	static long replay( FILE * input, cubeModel & state );
+
+private:
+	enum { BUFFER_SIZE = 1 << 16, MAX_TOKEN = 31 };
+
+	FILE * in;
+	char * buffer;	//Chunk read from input
+	int size;		//Bytes in buffer
+	int pos;		//Next byte to parse
+	char token[MAX_TOKEN + 1];	//Token being collected, may span chunks
+	int tokenLength;
+	bool comment;	//Inside a '#' comment
+	long line;
+	int errors;
+	long errorLine;
+
+	/*
+	 * Parses the collected token.  Returns true and sets out if it was a
+	 * move, records an error otherwise.
+	 */
+	bool finishToken( cubeModel::move & out );
+};
+#endif
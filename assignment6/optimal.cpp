@@ -0,0 +1,478 @@
+#include "optimal.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include "pruneTable.h"
+#include "workPool.h"
+
+//Table file header
+struct optimalHeader {
+	char magic[8];
+	unsigned int version;
+	unsigned int size;
+};
+static const char tableMagic[8] = { 'R', 'K', 'O', 'P', 'T', 'T', 'B', 'L' };
+static const unsigned int tableVersion = 1;
+
+static const size_t cornerOffset = sizeof( optimalHeader );
+static const size_t edgeOffset[2] = {
+	cornerOffset + optimalSolver::NUM_CORNER / 2,
+	cornerOffset + optimalSolver::NUM_CORNER / 2 + optimalSolver::NUM_EDGE / 2 };
+static const size_t tableSize = edgeOffset[1] + optimalSolver::NUM_EDGE / 2;
+
+/*
+ * Move tables shared by generation and search.  Built once by
+ * buildMoveTables() before any thread uses them.
+ */
+static unsigned short cornerPermMove[optimalSolver::NUM_CORNER_PERM][18];
+static unsigned short twistMove[optimalSolver::NUM_TWIST][18];
+static unsigned char edgeTo[18][12];	//Slot an edge in a slot moves to
+static unsigned char edgeFlip[18][12];	//Flip change of an edge in a slot
+static unsigned char bitCount[1 << 12];
+static bool movesBuilt = false;
+
+static void buildMoveTables() {
+	if( movesBuilt ) {
+		return;
+	}
+	for( int i = 0; i < optimalSolver::NUM_CORNER_PERM; i++ ) {
+		for( int m = 0; m < 18; m++ ) {
+			cubieCube c;
+			c.setCornerPerm( i );
+			c.move( m );
+			cornerPermMove[i][m] = c.getCornerPerm();
+		}
+	}
+	for( int i = 0; i < optimalSolver::NUM_TWIST; i++ ) {
+		for( int m = 0; m < 18; m++ ) {
+			cubieCube c;
+			c.setTwist( i );
+			c.move( m );
+			twistMove[i][m] = c.getTwist();
+		}
+	}
+	for( int m = 0; m < 18; m++ ) {
+		cubieCube c;
+		c.move( m );
+		for( int j = 0; j < 12; j++ ) {
+			edgeTo[m][c.ep[j]] = j;
+			edgeFlip[m][c.ep[j]] = c.eo[j];
+		}
+	}
+	for( int i = 0; i < ( 1 << 12 ); i++ ) {
+		bitCount[i] = ( i & 1 ) + bitCount[i >> 1];
+	}
+	movesBuilt = true;
+}
+
+/*
+ * Index of six edges from their slots and flips (bit i = flip of edge i).
+ */
+static inline int encodeEdges( const unsigned char * slot, int flips ) {
+	int used = 0;
+	int rank = 0;
+	for( int i = 0; i < 6; i++ ) {
+		int p = slot[i];
+		rank = rank * ( 12 - i ) + p - bitCount[used & ( ( 1 << p ) - 1 )];
+		used |= 1 << p;
+	}
+	return rank * 64 + flips;
+}
+
+static inline void decodeEdges( int index, unsigned char * slot, int & flips ) {
+	flips = index & 63;
+	int rank = index >> 6;
+	int digit[6];
+	for( int i = 5; i >= 0; i-- ) {
+		digit[i] = rank % ( 12 - i );
+		rank /= 12 - i;
+	}
+	int used = 0;
+	for( int i = 0; i < 6; i++ ) {
+		int p = 0;
+		for( int skip = digit[i]; ; p++ ) {
+			if( !( used & ( 1 << p ) ) && skip-- == 0 ) {
+				break;
+			}
+		}
+		slot[i] = p;
+		used |= 1 << p;
+	}
+}
+
+static inline int getNibble( const unsigned char * table, int index ) {
+	return ( table[index >> 1] >> ( ( index & 1 ) << 2 ) ) & 15;
+}
+
+int optimalSolver::cornerIndex( const cubieCube & cube ) {
+	return cube.getCornerPerm() * NUM_TWIST + cube.getTwist();
+}
+
+int optimalSolver::edgeIndex( const cubieCube & cube, int set ) {
+	buildMoveTables();
+	unsigned char slot[6];
+	int flips = 0;
+	for( int j = 0; j < 12; j++ ) {
+		int e = cube.ep[j] - set * 6;
+		if( e >= 0 && e < 6 ) {
+			slot[e] = j;
+			flips |= cube.eo[j] << e;
+		}
+	}
+	return encodeEdges( slot, flips );
+}
+
+/*
+ * Neighbours of a database entry under the 18 moves, for pruneTable.
+ */
+static int expandCorner( int index, int * out, const void * ) {
+	int perm = index / optimalSolver::NUM_TWIST;
+	int twist = index % optimalSolver::NUM_TWIST;
+	for( int m = 0; m < 18; m++ ) {
+		out[m] = cornerPermMove[perm][m] * optimalSolver::NUM_TWIST + twistMove[twist][m];
+	}
+	return 18;
+}
+
+static int expandEdge( int index, int * out, const void * ) {
+	unsigned char slot[6], moved[6];
+	int flips;
+	decodeEdges( index, slot, flips );
+	for( int m = 0; m < 18; m++ ) {
+		int f = flips;
+		for( int i = 0; i < 6; i++ ) {
+			moved[i] = edgeTo[m][slot[i]];
+			f ^= edgeFlip[m][slot[i]] << i;
+		}
+		out[m] = encodeEdges( moved, f );
+	}
+	return 18;
+}
+
+
+optimalSolver::optimalSolver() {
+	generated = NULL;
+	cornerTable = NULL;
+	edgeTable[0] = edgeTable[1] = NULL;
+	memset( &stats, 0, sizeof( stats ) );
+	pool = NULL;
+	splitDepth = 3;
+}
+
+optimalSolver::~optimalSolver() {
+	delete pool;
+	delete [] generated;
+}
+
+void optimalSolver::setTables( const unsigned char * base ) {
+	cornerTable = base + cornerOffset;
+	edgeTable[0] = base + edgeOffset[0];
+	edgeTable[1] = base + edgeOffset[1];
+}
+
+bool optimalSolver::load( const char * path ) {
+	buildMoveTables();
+	if( file.open( path ) && file.getSize() == tableSize ) {
+		const optimalHeader * header = (const optimalHeader *)file.getData();
+		if( memcmp( header->magic, tableMagic, 8 ) == 0 && header->version == tableVersion
+			&& header->size == tableSize ) {
+				setTables( (const unsigned char *)file.getData() );
+				return true;
+		}
+	}
+	file.close();
+
+	size_t size;
+	delete [] generated;
+	generated = generate( size );
+	if( !generated ) {
+		return false;
+	}
+	if( !mappedFile::write( path, generated, size ) ) {
+		std::cerr << "Could not save pattern databases to " << path << std::endl;
+	}
+	setTables( generated );
+	return true;
+}
+
+unsigned char * optimalSolver::generate( size_t & size ) {
+	buildMoveTables();
+	size = tableSize;
+	unsigned char * base = new unsigned char[size];
+	optimalHeader * header = (optimalHeader *)base;
+	memcpy( header->magic, tableMagic, 8 );
+	header->version = tableVersion;
+	header->size = (unsigned int)size;
+
+	cubieCube solved;
+	pruneTable::fill( base + cornerOffset, NUM_CORNER, cornerIndex( solved ), expandCorner, NULL, "corner" );
+	pruneTable::fill( base + edgeOffset[0], NUM_EDGE, edgeIndex( solved, 0 ), expandEdge, NULL, "edge set 0" );
+	pruneTable::fill( base + edgeOffset[1], NUM_EDGE, edgeIndex( solved, 1 ), expandEdge, NULL, "edge set 1" );
+	return base;
+}
+
+//Moves on the same face never follow each other, and moves on opposite
+//faces are only tried in one order.
+static inline bool allowedAfter( int m, int previous ) {
+	if( previous < 0 ) {
+		return true;
+	}
+	int face = m / 3;
+	int last = previous / 3;
+	return face != last && face != last - 3;
+}
+
+/*
+ * A node at the split depth, searched as one task by the work pool.
+ */
+struct optimalTask {
+	int perm, twist, flips;
+	unsigned char slot[12];
+	unsigned char moves[optimalSolver::MAX_SPLIT_DEPTH];
+};
+
+/*
+ * Shared by all searches of one iteration.
+ */
+struct optimalShared {
+	bool all;							//Gather every solution?
+	std::atomic<bool> stop;				//First solution found, stop searching
+	std::mutex lock;					//Guards the fields below
+	int count;							//Solutions found
+	std::vector<unsigned char> * solutions;
+
+	optimalShared( bool all, std::vector<unsigned char> * solutions )
+		: all( all ), stop( false ), count( 0 ), solutions( solutions ) {
+	}
+};
+
+/*
+ * State of one IDA* search.  The cube is tracked as corner coordinates
+ * and the slot and flip of every edge, which is all the heuristic needs.
+ */
+class optimalSearch {
+public:
+	optimalSearch( const optimalSolver & solver, optimalShared & shared )
+		: solver( solver ), shared( shared ), nodes( 0 ), splitAt( -1 ), tasks( NULL ) {
+	}
+
+	/*
+	 * Depth first search below one node with togo moves left.  Returns
+	 * true when the search should stop.
+	 */
+	bool search( int perm, int twist, const unsigned char * slot, int flips, int depth, int togo ) {
+		if( shared.stop.load( std::memory_order_relaxed ) ) {
+			return true;
+		}
+		if( depth == splitAt ) {
+			optimalTask task;
+			task.perm = perm;
+			task.twist = twist;
+			task.flips = flips;
+			memcpy( task.slot, slot, 12 );
+			memcpy( task.moves, moves, depth );
+			tasks->push_back( task );
+			return false;
+		}
+		nodes++;
+		if( togo == 0 ) {
+			return estimate( perm, twist, slot, flips ) == 0 && found( depth );
+		}
+		int previous = depth > 0 ? moves[depth - 1] : -1;
+		unsigned char moved[12];
+		for( int m = 0; m < 18; m++ ) {
+			if( !allowedAfter( m, previous ) ) {
+				continue;
+			}
+			//Cheapest test first: the corner bound needs no edge work
+			int p = cornerPermMove[perm][m];
+			int t = twistMove[twist][m];
+			if( getNibble( solver.cornerTable, p * optimalSolver::NUM_TWIST + t ) >= togo ) {
+				continue;
+			}
+			int f = flips;
+			for( int i = 0; i < 12; i++ ) {
+				moved[i] = edgeTo[m][slot[i]];
+				f ^= edgeFlip[m][slot[i]] << i;
+			}
+			if( getNibble( solver.edgeTable[0], encodeEdges( moved, f & 63 ) ) >= togo
+				|| getNibble( solver.edgeTable[1], encodeEdges( moved + 6, f >> 6 ) ) >= togo ) {
+				continue;
+			}
+			moves[depth] = m;
+			if( search( p, t, moved, f, depth + 1, togo - 1 ) ) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/*
+	 * Records a solution.  Returns true if searching should stop.
+	 */
+	bool found( int length ) {
+		std::lock_guard<std::mutex> guard( shared.lock );
+		if( shared.all ) {
+			shared.solutions->insert( shared.solutions->end(), moves, moves + length );
+			shared.count++;
+			return false;
+		}
+		if( !shared.stop ) {
+			shared.solutions->assign( moves, moves + length );
+			shared.count++;
+			shared.stop = true;
+		}
+		return true;
+	}
+
+	/*
+	 * Lower bound on the moves needed to solve a node.
+	 */
+	int estimate( int perm, int twist, const unsigned char * slot, int flips ) const {
+		int h = getNibble( solver.cornerTable, perm * optimalSolver::NUM_TWIST + twist );
+		int e = getNibble( solver.edgeTable[0], encodeEdges( slot, flips & 63 ) );
+		if( e > h ) {
+			h = e;
+		}
+		e = getNibble( solver.edgeTable[1], encodeEdges( slot + 6, flips >> 6 ) );
+		return e > h ? e : h;
+	}
+
+	const optimalSolver & solver;
+	optimalShared & shared;
+	long long nodes;
+	unsigned char moves[32];
+	int splitAt;						//Depth at which nodes become tasks, -1 = never
+	std::vector<optimalTask> * tasks;	//Where tasks are collected
+
+private:
+	optimalSearch & operator=( const optimalSearch & );
+};
+
+void optimalSolver::setThreads( int threads ) {
+	delete pool;
+	pool = threads == 1 ? NULL : new workPool( threads );
+}
+
+int optimalSolver::getThreads() const {
+	return pool ? pool->getThreads() : 1;
+}
+
+void optimalSolver::setSplitDepth( int depth ) {
+	splitDepth = depth < 1 ? 1 : depth > MAX_SPLIT_DEPTH ? MAX_SPLIT_DEPTH : depth;
+}
+
+int optimalSolver::solve( const cubieCube & cube, unsigned char * out, int maxLength ) {
+	std::vector<unsigned char> solution;
+	int length = run( cube, solution, false, maxLength );
+	if( length > 0 ) {
+		memcpy( out, &solution[0], length );
+	}
+	return length;
+}
+
+int optimalSolver::solveAll( const cubieCube & cube, std::vector<unsigned char> & solutions, int maxLength ) {
+	solutions.clear();
+	return run( cube, solutions, true, maxLength );
+}
+
+int optimalSolver::run( const cubieCube & cube, std::vector<unsigned char> & solutions, bool all, int maxLength ) {
+	memset( &stats, 0, sizeof( stats ) );
+	if( !isLoaded() || maxLength > 31 ) {
+		return -1;
+	}
+
+	unsigned char slot[12];
+	int flips = 0;
+	for( int j = 0; j < 12; j++ ) {
+		slot[cube.ep[j]] = j;
+		flips |= cube.eo[j] << cube.ep[j];
+	}
+	int perm = cube.getCornerPerm();
+	int twist = cube.getTwist();
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	int length = -1;
+	optimalShared none( all, NULL );
+	int bound = optimalSearch( *this, none ).estimate( perm, twist, slot, flips );
+	for( ; bound <= maxLength && length < 0; bound++ ) {
+		std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+		optimalShared shared( all, &solutions );
+		optimalSearch root( *this, shared );
+		std::atomic<long long> nodes( 0 );
+
+		if( !pool || bound <= splitDepth ) {
+			root.search( perm, twist, slot, flips, 0, bound );
+		}
+		else {
+			//Search down to the split depth, then hand the subtrees to the pool
+			std::vector<optimalTask> tasks;
+			root.splitAt = splitDepth;
+			root.tasks = &tasks;
+			root.search( perm, twist, slot, flips, 0, bound );
+			pool->run( (int)tasks.size(), [&]( int worker, int i ) {
+				const optimalTask & task = tasks[i];
+				optimalSearch search( *this, shared );
+				memcpy( search.moves, task.moves, splitDepth );
+				if( search.search( task.perm, task.twist, task.slot, task.flips, splitDepth, bound - splitDepth ) ) {
+					pool->cancel();
+				}
+				nodes += search.nodes;
+			} );
+		}
+
+		stats.depthNodes[bound] = root.nodes + nodes;
+		stats.nodes += stats.depthNodes[bound];
+		stats.depthMillis[bound] = std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - begin ).count();
+		if( shared.count > 0 ) {
+			length = bound;
+		}
+	}
+	stats.millis = std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - start ).count();
+	return length;
+}
+
+void optimalSolver::benchmark( int count, int scrambleLength, unsigned int seed ) {
+	long long depthNodes[32] = { 0 };
+	double depthMillis[32] = { 0 };
+	long long totalNodes = 0;
+	double totalMillis = 0;
+	unsigned char moves[32];
+
+	for( int i = 0; i < count; i++ ) {
+		cubieCube cube;
+		int previous = -1;
+		for( int k = 0; k < scrambleLength; k++ ) {
+			int m;
+			do {
+				seed = seed * 1103515245 + 12345;
+				m = ( seed >> 16 ) % 18;
+			} while( !allowedAfter( m, previous ) );
+			cube.move( m );
+			previous = m;
+		}
+		int length = solve( cube, moves );
+		printf( "State %d: %d moves, %lld nodes, %.1f ms\n", i + 1, length, stats.nodes, stats.millis );
+		for( int d = 0; d < 32; d++ ) {
+			depthNodes[d] += stats.depthNodes[d];
+			depthMillis[d] += stats.depthMillis[d];
+		}
+		totalNodes += stats.nodes;
+		totalMillis += stats.millis;
+	}
+
+	printf( "Bound       nodes          ms\n" );
+	for( int d = 0; d < 32; d++ ) {
+		if( depthNodes[d] ) {
+			printf( "%5d %11lld %11.1f\n", d, depthNodes[d], depthMillis[d] );
+		}
+	}
+	printf( "Optimal: %d states, %d threads, %lld nodes in %.0f ms, %.2f M nodes/s\n", count,
+		getThreads(), totalNodes, totalMillis, totalMillis > 0 ? totalNodes / totalMillis / 1000 : 0.0 );
+}
@@ -0,0 +1,144 @@
+//Header file for Rubiks cube project
+#ifndef OPTIMAL_H
+#define OPTIMAL_H
+#include "cubieCube.h"
+#include "mappedFile.h"
+#include <vector>
+
+class workPool;
+
+/*
+ * Optimal solver for the 3x3 cube.
+ *
+ * IDA* over the 18 face moves with a pattern database heuristic: the
+ * larger of the exact distances of the corners alone (8! * 3^7 entries)
+ * and of two sets of six edges (12!/6! * 2^6 entries each).  Distances
+ * are stored in 4 bits per entry, about 86 MB in total.
+ *
+ * The databases are built once by a multithreaded breadth-first fill,
+ * saved to a file and mapped on later runs.
+ *
+ * With more than one thread, each IDA* iteration searches down to the
+ * split depth and hands the remaining subtrees to a work-stealing pool.
+ */
+class optimalSolver {
+public:
+	/*
+	 * Statistics of the last solve.  depthNodes[d] and depthMillis[d]
+	 * are the nodes expanded and time spent by the iteration with bound d.
+	 */
+	struct Stats {
+		long long nodes;
+		double millis;
+		long long depthNodes[32];
+		double depthMillis[32];
+	};
+
+	/*
+	 * Constructor.  Call load() before solving.
+	 */
+	optimalSolver();
+
+	/*
+	 * Destructor
+	 */
+	~optimalSolver();
+
+	/*
+	 * Maps the databases stored at path.  If the file is missing or was
+	 * written by a different version, the databases are generated with
+	 * all cores and saved there first.  Returns false on failure.
+	 */
+	bool load( const char * path );
+
+	/*
+	 * Returns whether databases are loaded.
+	 */
+	bool isLoaded() const { return cornerTable != NULL; }
+
+	/*
+	 * Finds a shortest solution of at most maxLength moves.  Moves are
+	 * written to out (cubieCube move numbers).  Returns the number of
+	 * moves, or -1 if there is no solution within maxLength.
+	 */
+	int solve( const cubieCube & cube, unsigned char * out, int maxLength = 20 );
+
+	/*
+	 * Finds every shortest solution.  They are stored one after the other
+	 * in solutions, each as long as the returned length.  Returns -1 if
+	 * there is no solution within maxLength.
+	 */
+	int solveAll( const cubieCube & cube, std::vector<unsigned char> & solutions, int maxLength = 20 );
+
+	/*
+	 * Number of search threads, 0 = one per hardware thread.  The default
+	 * is a single thread.
+	 */
+	void setThreads( int threads );
+	int getThreads() const;
+
+	/*
+	 * Depth at which the search is split into parallel tasks (1 to
+	 * MAX_SPLIT_DEPTH, default 3).  Deeper splits give more, smaller tasks.
+	 */
+	void setSplitDepth( int depth );
+
+	/*
+	 * Statistics of the last call to solve().
+	 */
+	const Stats & getStats() const { return stats; }
+
+	/*
+	 * Solves count states scrambled with scrambleLength random moves and
+	 * prints per-depth timings and nodes per second to stdout.
+	 */
+	void benchmark( int count, int scrambleLength, unsigned int seed );
+
+	enum {
+		NUM_CORNER_PERM = 40320,
+		NUM_TWIST = 2187,
+		NUM_CORNER = NUM_CORNER_PERM * NUM_TWIST,	//88,179,840
+		NUM_EDGE_PERM = 665280,						//12!/6!
+		NUM_EDGE = NUM_EDGE_PERM * 64,				//42,577,920
+		MAX_SPLIT_DEPTH = 8
+	};
+
+	/*
+	 * Pattern database indices.  set 0 is edges UR-DF, set 1 is DL-BR.
+	 */
+	static int cornerIndex( const cubieCube & cube );
+	static int edgeIndex( const cubieCube & cube, int set );
+
+private:
+	friend class optimalSearch;
+
+	mappedFile file;
+	unsigned char * generated;	//Tables built this run, NULL if mapped
+	Stats stats;
+	workPool * pool;	//Search threads, NULL for a single thread
+	int splitDepth;
+
+	//Pattern databases, 4 bits per entry
+	const unsigned char * cornerTable;
+	const unsigned char * edgeTable[2];
+
+	/*
+	 * Iterative deepening shared by solve() and solveAll().
+	 */
+	int run( const cubieCube & cube, std::vector<unsigned char> & solutions, bool all, int maxLength );
+
+	/*
+	 * Points the table pointers into a buffer in the file layout.
+	 */
+	void setTables( const unsigned char * base );
+
+	/*
+	 * Builds all tables into a buffer in the file layout.
+	 */
+	static unsigned char * generate( size_t & size );
+
+	//Not copyable
+	optimalSolver( const optimalSolver & );
+	optimalSolver & operator=( const optimalSolver & );
+};
+#endif
@@ -0,0 +1,257 @@
+#include "pocket.h"
+#include "cubeValidator.h"
+#include "pruneTable.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+//Table file header
+struct pocketHeader {
+	char magic[8];
+	unsigned int version;
+	unsigned int size;
+};
+static const char tableMagic[8] = { 'R', 'K', 'P', 'O', 'C', 'K', 'E', 'T' };
+static const unsigned int tableVersion = 1;
+
+static const size_t tableOffset = sizeof( pocketHeader );
+static const size_t tableSize = tableOffset + ( pocketSolver::NUM_STATES + 3 ) / 4;
+
+//Slots of the seven moving corners; DBL (slot 6) never moves
+static const int movingSlots[7] = { 0, 1, 2, 3, 4, 5, 7 };
+
+/*
+ * Move tables over the permutation of the seven moving corners and the
+ * twist of the first six.  Built once by buildMoveTables().
+ */
+static unsigned short permMove[pocketSolver::NUM_PERM][pocketSolver::NUM_MOVES];
+static unsigned short twistMove[pocketSolver::NUM_TWIST][pocketSolver::NUM_MOVES];
+static bool movesBuilt = false;
+
+static int permCoord( const cubieCube & c ) {
+	unsigned char perm[7];
+	for( int i = 0; i < 7; i++ ) {
+		perm[i] = c.cp[movingSlots[i]] == 7 ? 6 : c.cp[movingSlots[i]];
+	}
+	return cubieCube::permIndex( perm, 7 );
+}
+
+static int twistCoord( const cubieCube & c ) {
+	int twist = 0;
+	for( int i = 0; i < 6; i++ ) {
+		twist = twist * 3 + c.co[i];
+	}
+	return twist;
+}
+
+static void buildMoveTables() {
+	if( movesBuilt ) {
+		return;
+	}
+	for( int i = 0; i < pocketSolver::NUM_PERM; i++ ) {
+		unsigned char perm[7];
+		cubieCube::permFromIndex( i, perm, 7 );
+		cubieCube c;
+		for( int k = 0; k < 7; k++ ) {
+			c.cp[movingSlots[k]] = perm[k] == 6 ? 7 : perm[k];
+		}
+		for( int m = 0; m < pocketSolver::NUM_MOVES; m++ ) {
+			cubieCube moved = c;
+			moved.move( m );
+			permMove[i][m] = permCoord( moved );
+		}
+	}
+	for( int i = 0; i < pocketSolver::NUM_TWIST; i++ ) {
+		cubieCube c;
+		int sum = 0;
+		for( int k = 5, t = i; k >= 0; k--, t /= 3 ) {
+			c.co[k] = t % 3;
+			sum += t % 3;
+		}
+		c.co[7] = ( 3 - sum % 3 ) % 3;
+		for( int m = 0; m < pocketSolver::NUM_MOVES; m++ ) {
+			cubieCube moved = c;
+			moved.move( m );
+			twistMove[i][m] = twistCoord( moved );
+		}
+	}
+	movesBuilt = true;
+}
+
+static inline int neighbour( int index, int m ) {
+	return permMove[index / pocketSolver::NUM_TWIST][m] * pocketSolver::NUM_TWIST
+		+ twistMove[index % pocketSolver::NUM_TWIST][m];
+}
+
+static inline int getEntry( const unsigned char * table, int index ) {
+	return ( table[index >> 2] >> ( ( index & 3 ) << 1 ) ) & 3;
+}
+
+pocketSolver::pocketSolver() {
+	generated = NULL;
+	table = NULL;
+}
+
+pocketSolver::~pocketSolver() {
+	delete [] generated;
+}
+
+bool pocketSolver::load( const char * path ) {
+	buildMoveTables();
+	if( file.open( path ) && file.getSize() == tableSize ) {
+		const pocketHeader * header = (const pocketHeader *)file.getData();
+		if( memcmp( header->magic, tableMagic, 8 ) == 0 && header->version == tableVersion
+			&& header->size == tableSize ) {
+				table = (const unsigned char *)file.getData() + tableOffset;
+				return true;
+		}
+	}
+	file.close();
+
+	size_t size;
+	delete [] generated;
+	generated = generate( size );
+	if( !generated ) {
+		return false;
+	}
+	if( !mappedFile::write( path, generated, size ) ) {
+		std::cerr << "Could not save 2x2 table to " << path << std::endl;
+	}
+	table = generated + tableOffset;
+	return true;
+}
+
+//Neighbours of a state under the nine moves, for pruneTable
+static int expandState( int index, int * out, const void * ) {
+	for( int m = 0; m < pocketSolver::NUM_MOVES; m++ ) {
+		out[m] = neighbour( index, m );
+	}
+	return pocketSolver::NUM_MOVES;
+}
+
+/*
+ * Fills exact distances with pruneTable (every state is within 11 moves)
+ * and packs them to 2 bits, modulo 3.
+ */
+unsigned char * pocketSolver::generate( size_t & size ) {
+	buildMoveTables();
+	size = tableSize;
+	unsigned char * base = new unsigned char[size];
+	memset( base, 0, size );
+	pocketHeader * header = (pocketHeader *)base;
+	memcpy( header->magic, tableMagic, 8 );
+	header->version = tableVersion;
+	header->size = (unsigned int)size;
+
+	unsigned char * depths = new unsigned char[( NUM_STATES + 1 ) / 2];
+	pruneTable::fill( depths, NUM_STATES, 0, expandState, NULL, "2x2" );
+
+	unsigned char * out = base + tableOffset;
+	for( int i = 0; i < NUM_STATES; i++ ) {
+		int depth = ( depths[i >> 1] >> ( ( i & 1 ) << 2 ) ) & 15;
+		out[i >> 2] |= ( depth % 3 ) << ( ( i & 3 ) << 1 );
+	}
+	delete [] depths;
+	return base;
+}
+
+int pocketSolver::stateIndex( const cubeModel & state ) {
+	if( state.getDimensions() != 2 || cubeValidator::validate( state ) != cubeValidator::VALID ) {
+		return -1;
+	}
+	buildMoveTables();
+
+	//The fixed corner decides which color belongs on each face
+	const unsigned char * s = state.getStickers();
+	int home[6];
+	for( int t = 0; t < 3; t++ ) {
+		int face = cubeModel::cornerSlots[6][t][0];
+		int color = s[state.slotSticker( cubeModel::cornerSlots[6][t] )];
+		home[color] = face;
+		home[color ^ 1] = face ^ 1;
+	}
+
+	cubieCube cube;
+	for( int i = 0; i < 8; i++ ) {
+		int c[3];
+		for( int t = 0; t < 3; t++ ) {
+			c[t] = home[s[state.slotSticker( cubeModel::cornerSlots[i][t] )]];
+		}
+		int ori;
+		for( ori = 0; ori < 3; ori++ ) {
+			if( c[ori] == cubeModel::TOP || c[ori] == cubeModel::BOTTOM ) {
+				break;
+			}
+		}
+		for( int j = 0; j < 8; j++ ) {
+			if( c[ori] == cubeModel::cornerSlots[j][0][0]
+				&& c[( ori + 1 ) % 3] == cubeModel::cornerSlots[j][1][0]
+				&& c[( ori + 2 ) % 3] == cubeModel::cornerSlots[j][2][0] ) {
+					cube.cp[i] = j;
+			}
+		}
+		cube.co[i] = ori;
+	}
+	return permCoord( cube ) * NUM_TWIST + twistCoord( cube );
+}
+
+int pocketSolver::solve( int index, unsigned char * out ) const {
+	int length = 0;
+	while( index != 0 ) {
+		//The neighbour one move closer is the one a step lower modulo 3
+		int closer = ( getEntry( table, index ) + 2 ) % 3;
+		int m;
+		for( m = 0; m < NUM_MOVES; m++ ) {
+			int next = neighbour( index, m );
+			if( getEntry( table, next ) == closer ) {
+				index = next;
+				break;
+			}
+		}
+		if( m == NUM_MOVES || length == MAX_LENGTH ) {
+			return -1;
+		}
+		out[length++] = (unsigned char)m;
+	}
+	return length;
+}
+
+int pocketSolver::solve( const cubeModel & state, cubeModel::move * out ) const {
+	int index = stateIndex( state );
+	if( index < 0 || !isLoaded() ) {
+		return -1;
+	}
+	unsigned char moves[MAX_LENGTH];
+	int length = solve( index, moves );
+	for( int i = 0; i < length; i++ ) {
+		out[i] = cubieCube::toMove( moves[i] );
+	}
+	return length;
+}
+
+void pocketSolver::benchmark( int count, unsigned int seed ) const {
+	long long lengths[MAX_LENGTH + 1] = { 0 };
+	unsigned char moves[MAX_LENGTH];
+	int failed = 0;
+	std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+	for( int i = 0; i < count; i++ ) {
+		seed = seed * 1103515245 + 12345;
+		int index = (int)( ( seed >> 8 ) % NUM_STATES );
+		int length = solve( index, moves );
+		if( length < 0 ) {
+			failed++;
+			continue;
+		}
+		lengths[length]++;
+	}
+	double millis = std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - begin ).count();
+	printf( "2x2: %d random states in %.1f ms, %.2f us/solve, failed: %d\n",
+		count, millis, count ? millis * 1000 / count : 0.0, failed );
+	for( int d = 0; d <= MAX_LENGTH; d++ ) {
+		if( lengths[d] ) {
+			printf( "%5d moves: %lld\n", d, lengths[d] );
+		}
+	}
+}
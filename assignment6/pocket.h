@@ -0,0 +1,92 @@
+//Header file for Rubiks cube project
+#ifndef POCKET_H
+#define POCKET_H
+#include "cubieCube.h"
+#include "mappedFile.h"
+
+/*
+ * Optimal solver for the 2x2 cube from a complete distance table.
+ *
+ * With the down-back-left corner held fixed, U, R and F turns reach all
+ * 7! * 3^6 = 3,674,160 states.  The table stores each state's distance
+ * from solved (in face turns) modulo 3 in 2 bits, under 1 MB in total.
+ * The neighbours of a state are one closer, equally far or one further,
+ * which modulo 3 are all different, so an optimal solution is found by
+ * stepping to the neighbour one closer until the cube is solved.
+ *
+ * The table is built once by a multithreaded breadth-first fill, saved
+ * to a file and mapped on later runs.
+ */
+class pocketSolver {
+public:
+	/*
+	 * Constructor.  Call load() before solving.
+	 */
+	pocketSolver();
+
+	/*
+	 * Destructor
+	 */
+	~pocketSolver();
+
+	/*
+	 * Maps the table stored at path.  If the file is missing or was
+	 * written by a different version, the table is generated and saved
+	 * there first.  Returns false on failure.
+	 */
+	bool load( const char * path );
+
+	/*
+	 * Returns whether the table is loaded.
+	 */
+	bool isLoaded() const { return table != NULL; }
+
+	/*
+	 * Finds a shortest solution of a 2x2 sticker state.  Writes packed
+	 * moves to out, which needs room for MAX_LENGTH moves.  Returns the
+	 * number of moves, or -1 if the state is not a valid 2x2.
+	 */
+	int solve( const cubeModel & state, cubeModel::move * out ) const;
+
+	/*
+	 * Finds a shortest solution for a state index.  Writes cubieCube move
+	 * numbers (U, R and F turns only) to out.
+	 */
+	int solve( int index, unsigned char * out ) const;
+
+	/*
+	 * Solves count random states and prints solve times and the
+	 * distribution of distances to stdout.
+	 */
+	void benchmark( int count, unsigned int seed ) const;
+
+	/*
+	 * State index of a 2x2 sticker state, or -1 if it is not valid.
+	 * Colors are taken relative to the down-back-left corner, so whole
+	 * cube rotations do not matter.
+	 */
+	static int stateIndex( const cubeModel & state );
+
+	enum {
+		NUM_PERM = 5040,
+		NUM_TWIST = 729,
+		NUM_STATES = NUM_PERM * NUM_TWIST,	//3,674,160
+		NUM_MOVES = 9,						//U, R, F in cubieCube numbering
+		MAX_LENGTH = 11						//Diameter in face turns
+	};
+
+private:
+	mappedFile file;
+	unsigned char * generated;	//Table built this run, NULL if mapped
+	const unsigned char * table;	//Distance mod 3, 2 bits per state
+
+	/*
+	 * Builds the table in the file layout.
+	 */
+	static unsigned char * generate( size_t & size );
+
+	//Not copyable
+	pocketSolver( const pocketSolver & );
+	pocketSolver & operator=( const pocketSolver & );
+};
+#endif
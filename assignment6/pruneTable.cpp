@@ -0,0 +1,181 @@
+#include "pruneTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+typedef std::atomic<unsigned long long> word;
+
+static pruneTable::progressFunc progressReport = NULL;
+static void * progressData = NULL;
+static int fillThreads = 0;
+static FILE * progressLog = NULL;
+
+//Default progress report: a header, then a line per depth
+static void printProgress( const pruneTable::Progress & p, void * data ) {
+	FILE * log = progressLog ? progressLog : stdout;
+	if( p.depth == 0 ) {
+		fprintf( log, "Building %s table (%lld entries)\n", p.name, p.size );
+	}
+	else {
+		fprintf( log, "  depth %2d: %10lld entries, %8.0f ms%s\n", p.depth, p.found, p.millis,
+			p.backward ? " (backward)" : "" );
+	}
+	fflush( log );
+}
+
+void pruneTable::setProgress( progressFunc func, void * data ) {
+	progressReport = func;
+	progressData = data;
+}
+
+void pruneTable::setLog( FILE * log ) {
+	progressLog = log;
+}
+
+void pruneTable::setThreads( int threads ) {
+	fillThreads = threads;
+}
+
+static inline int entry( unsigned long long bits, int k ) {
+	return (int)( bits >> ( k * 4 ) ) & 15;
+}
+
+/*
+ * Expands the entries at depth in words [begin, end) and claims their
+ * unknown neighbours for depth + 1.
+ */
+static long long expandForward( word * words, int begin, int end, int size, int depth,
+	pruneTable::expandFunc expand, const void * data ) {
+	int neighbours[pruneTable::MAX_MOVES];
+	long long count = 0;
+	for( int w = begin; w < end; w++ ) {
+		unsigned long long bits = words[w].load( std::memory_order_relaxed );
+		for( int k = 0; k < 16; k++ ) {
+			if( entry( bits, k ) != depth ) {
+				continue;
+			}
+			int index = w * 16 + k;
+			if( index >= size ) {
+				break;
+			}
+			int numMoves = expand( index, neighbours, data );
+			for( int m = 0; m < numMoves; m++ ) {
+				int n = neighbours[m];
+				word & target = words[n >> 4];
+				int shift = ( n & 15 ) * 4;
+				unsigned long long old = target.load( std::memory_order_relaxed );
+				while( ( ( old >> shift ) & 15 ) == 15 ) {
+					unsigned long long value = ( old & ~( 15ULL << shift ) )
+						| ( (unsigned long long)( depth + 1 ) << shift );
+					if( target.compare_exchange_weak( old, value, std::memory_order_relaxed ) ) {
+						count++;
+						break;
+					}
+				}
+			}
+		}
+	}
+	return count;
+}
+
+/*
+ * Sets each unknown entry in words [begin, end) with a neighbour at depth
+ * to depth + 1.  Only this thread writes these words, so each is stored
+ * once; other threads only read them and never look for depth + 1.
+ */
+static long long expandBackward( word * words, int begin, int end, int size, int depth,
+	pruneTable::expandFunc expand, const void * data ) {
+	int neighbours[pruneTable::MAX_MOVES];
+	long long count = 0;
+	for( int w = begin; w < end; w++ ) {
+		unsigned long long bits = words[w].load( std::memory_order_relaxed );
+		unsigned long long value = bits;
+		for( int k = 0; k < 16; k++ ) {
+			int index = w * 16 + k;
+			if( entry( bits, k ) != 15 || index >= size ) {
+				continue;
+			}
+			int numMoves = expand( index, neighbours, data );
+			for( int m = 0; m < numMoves; m++ ) {
+				int n = neighbours[m];
+				if( entry( words[n >> 4].load( std::memory_order_relaxed ), n & 15 ) == depth ) {
+					value &= ~( 15ULL << ( k * 4 ) );
+					value |= (unsigned long long)( depth + 1 ) << ( k * 4 );
+					count++;
+					break;
+				}
+			}
+		}
+		if( value != bits ) {
+			words[w].store( value, std::memory_order_relaxed );
+		}
+	}
+	return count;
+}
+
+void pruneTable::fill( unsigned char * out, int size, int start, expandFunc expand, const void * data,
+	const char * name ) {
+	const int numWords = ( size + 15 ) / 16;
+	word * words = new word[numWords];
+	for( int i = 0; i < numWords; i++ ) {
+		words[i].store( ~0ULL, std::memory_order_relaxed );
+	}
+	words[start >> 4].store( ~( 15ULL << ( ( start & 15 ) * 4 ) ), std::memory_order_relaxed );
+
+	int numThreads = fillThreads > 0 ? fillThreads : std::thread::hardware_concurrency();
+	if( numThreads < 1 ) {
+		numThreads = 1;
+	}
+	progressFunc report = progressReport ? progressReport : printProgress;
+	Progress progress = { name, 0, 1, 1, size, 0.0, false };
+	report( progress, progressData );
+
+	long long found = 1;
+	for( int depth = 0; depth < MAX_DEPTH && progress.filled < size; depth++ ) {
+		std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+		bool backward = size - progress.filled < found;
+		std::atomic<int> nextWord( 0 );
+		std::atomic<long long> count( 0 );
+		const int blockWords = 4096;
+
+		std::vector<std::thread> workers;
+		for( int t = 0; t < numThreads; t++ ) {
+			workers.push_back( std::thread( [&]() {
+				long long local = 0;
+				int block;
+				while( ( block = nextWord.fetch_add( blockWords ) ) < numWords ) {
+					int end = block + blockWords < numWords ? block + blockWords : numWords;
+					local += backward ? expandBackward( words, block, end, size, depth, expand, data )
+						: expandForward( words, block, end, size, depth, expand, data );
+				}
+				count += local;
+			} ) );
+		}
+		for( int t = 0; t < numThreads; t++ ) {
+			workers[t].join();
+		}
+
+		found = count;
+		progress.depth = depth + 1;
+		progress.found = found;
+		progress.filled += found;
+		progress.millis = std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - begin ).count();
+		progress.backward = backward;
+		report( progress, progressData );
+		if( found == 0 ) {
+			break;
+		}
+	}
+
+	//Words hold 16 entries, low nibble first, the same order as the bytes
+	for( int i = 0; i < numWords; i++ ) {
+		unsigned long long bits = words[i].load( std::memory_order_relaxed );
+		for( int b = 0; b < 8 && i * 8 + b < ( size + 1 ) / 2; b++ ) {
+			out[i * 8 + b] = (unsigned char)( bits >> ( b * 8 ) );
+		}
+	}
+	delete [] words;
+}
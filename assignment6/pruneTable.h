@@ -0,0 +1,76 @@
+//Header file for Rubiks cube project
+#ifndef PRUNETABLE_H
+#define PRUNETABLE_H
+#include <cstdio>
+
+/*
+ * Multithreaded breadth-first fill of a distance table with 4 bits per
+ * entry (low nibble first, 15 = not reached), shared by every pruning
+ * table and pattern database the solvers build.
+ *
+ * Entries are kept in 64-bit atomic words of 16 entries.  Each depth,
+ * threads claim blocks of words and expand the entries at that depth;
+ * a neighbour is set with a compare-and-swap on its word that only
+ * succeeds while the entry is still unknown, so no locks are needed and
+ * every entry is counted once.  Once fewer entries are unknown than were
+ * just reached, a depth is filled backwards instead: each unknown entry
+ * looks for a neighbour at the current depth, which is much faster for
+ * the last, largest depths.  This needs the moves to be closed under
+ * inverses, as all face turn sets are.
+ *
+ * Progress is reported after every depth, by default as a line in the
+ * log (stdout unless changed with setLog()).
+ */
+class pruneTable {
+public:
+	/*
+	 * Writes the neighbours of an entry under every move to out and
+	 * returns how many there are (at most MAX_MOVES).  data is the
+	 * pointer given to fill().
+	 */
+	typedef int (*expandFunc)( int index, int * out, const void * data );
+
+	/*
+	 * State of a fill after a depth is done.
+	 */
+	struct Progress {
+		const char * name;		//Name given to fill()
+		int depth;				//Depth just filled
+		long long found;		//Entries at this depth
+		long long filled;		//Entries reached so far
+		long long size;			//Entries in the table
+		double millis;			//Time for this depth
+		bool backward;			//Depth was filled backwards
+	};
+
+	/*
+	 * Receives progress of every fill.
+	 */
+	typedef void (*progressFunc)( const Progress & progress, void * data );
+
+	/*
+	 * Fills out, (size + 1) / 2 bytes, with the distance of every entry
+	 * from start.  Entries further than 14 are left at 15.
+	 */
+	static void fill( unsigned char * out, int size, int start, expandFunc expand, const void * data,
+		const char * name );
+
+	/*
+	 * Replaces the progress report for all later fills.  NULL restores
+	 * the default.
+	 */
+	static void setProgress( progressFunc func, void * data );
+
+	/*
+	 * Where the default progress report is written.
+	 */
+	static void setLog( FILE * log );
+
+	/*
+	 * Number of fill threads, 0 = one per hardware thread (the default).
+	 */
+	static void setThreads( int threads );
+
+	enum { MAX_MOVES = 18, MAX_DEPTH = 14 };
+};
+#endif
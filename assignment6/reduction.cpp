@@ -0,0 +1,738 @@
+#include "reduction.h"
+#include "cubeValidator.h"
+
+typedef cubeModel::move move;
+
+//Edge slot between two faces, or -1 if they are not adjacent
+static int edgeFromFaces( int a, int b ) {
+	for( int e = 0; e < 12; e++ ) {
+		int h0 = cubeModel::edgeSlots[e][0][0];
+		int h1 = cubeModel::edgeSlots[e][1][0];
+		if( ( a == h0 && b == h1 ) || ( a == h1 && b == h0 ) ) {
+			return e;
+		}
+	}
+	return -1;
+}
+
+//Outer layer turn
+static move faceTurn( int face, int quarters ) {
+	return cubeModel::makeMove( face, quarters, 0, 0 );
+}
+
+//Single layer turn
+static move layerTurn( int face, int quarters, int layer ) {
+	return cubeModel::makeMove( face, quarters, layer, layer );
+}
+
+//Writes the inverse of a sequence to out
+static int invert( const move * moves, int length, move * out ) {
+	for( int i = 0; i < length; i++ ) {
+		out[i] = cubeModel::inverse( moves[length - 1 - i] );
+	}
+	return length;
+}
+
+/*
+ * Canonical commutators, with Top/Front/Right/Left standing for the faces
+ * of a frame.  Both are pure 3-cycles:
+ *
+ * Centers, c and b inner columns with c != b, r = N - b:
+ *	cR U bL' U' cR' U bL U'
+ *	moves the center at Front(r, c) to Top(r, c), Top(r, c) to Front(c, b)
+ *	and Front(c, b) to Front(r, c).
+ *
+ * Wings, c an inner column:
+ *	cR U R' U' cR' U R U'
+ *	cycles the wings at column c of the Top-Front, Top-Back and Back-Right
+ *	edges.
+ *
+ * cR and bL are single inner layers at x = c and x = b.
+ */
+static int centerCommutator( int n, int c, int b, move * out ) {
+	int right = n - c;
+	out[0] = layerTurn( cubeModel::RIGHT, 1, right );
+	out[1] = faceTurn( cubeModel::TOP, 1 );
+	out[2] = layerTurn( cubeModel::LEFT, 3, b );
+	out[3] = faceTurn( cubeModel::TOP, 3 );
+	out[4] = layerTurn( cubeModel::RIGHT, 3, right );
+	out[5] = faceTurn( cubeModel::TOP, 1 );
+	out[6] = layerTurn( cubeModel::LEFT, 1, b );
+	out[7] = faceTurn( cubeModel::TOP, 3 );
+	return 8;
+}
+
+static int wingCommutator( int n, int c, move * out ) {
+	int right = n - c;
+	out[0] = layerTurn( cubeModel::RIGHT, 1, right );
+	out[1] = faceTurn( cubeModel::TOP, 1 );
+	out[2] = faceTurn( cubeModel::RIGHT, 3 );
+	out[3] = faceTurn( cubeModel::TOP, 3 );
+	out[4] = layerTurn( cubeModel::RIGHT, 3, right );
+	out[5] = faceTurn( cubeModel::TOP, 1 );
+	out[6] = faceTurn( cubeModel::RIGHT, 1 );
+	out[7] = faceTurn( cubeModel::TOP, 3 );
+	return 8;
+}
+
+reductionSolver::reductionSolver( const kociembaSolver & finisher ) : finisher( finisher ) {
+	cube = NULL;
+	cancel = NULL;
+	dim = 0;
+	sink = NULL;
+	data = NULL;
+	count = 0;
+	cycleDim = 0;
+
+	//Every orientation: any front face with any of its four neighbours on top
+	int n = 0;
+	for( int front = 0; front < 6; front++ ) {
+		for( int top = 0; top < 6; top++ ) {
+			if( top != front && top != ( front ^ 1 ) ) {
+				makeFrame( front, top, frames[n++] );
+			}
+		}
+	}
+
+	//Setups up to 3 outer turns.  Same face twice in a row is never needed
+	//and opposite faces commute, so only one order of those is kept.
+	setup s;
+	s.length = 0;
+	setups.push_back( s );
+	for( size_t i = 0; i < setups.size(); i++ ) {
+		if( setups[i].length == 3 ) {
+			continue;
+		}
+		int last = setups[i].length ? cubeModel::moveFace( setups[i].moves[setups[i].length - 1] ) : -1;
+		for( int face = 0; face < 6; face++ ) {
+			if( face == last || ( face == ( last ^ 1 ) && face < last ) ) {
+				continue;
+			}
+			for( int q = 1; q <= 3; q++ ) {
+				s = setups[i];
+				s.moves[s.length++] = faceTurn( face, q );
+				setups.push_back( s );
+			}
+		}
+	}
+}
+
+reductionSolver::~reductionSolver() {
+	delete cube;
+}
+
+long reductionSolver::solve( const cubeModel & state, moveSink sink, void * data ) {
+	dim = state.getDimensions();
+	if( dim < 3 || cubeValidator::validate( state ) != cubeValidator::VALID || !finisher.isLoaded() ) {
+		return -1;
+	}
+	delete cube;
+	cube = new cubeModel( state );
+	this->sink = sink;
+	this->data = data;
+	count = 0;
+
+	//Odd cubes keep their middle centers, even cubes are solved to the
+	//standard color scheme
+	for( int f = 0; f < 6; f++ ) {
+		colorOf[f] = dim % 2 ? cube->get( f, dim / 2, dim / 2 ) : f;
+		home[colorOf[f]] = f;
+	}
+
+	if( dim > 3 ) {
+		if( cycleDim != dim ) {
+			buildCycles();
+		}
+		fixWingParity();
+		if( !solveCenters() ) {
+			return -1;
+		}
+		fixCornerParity();
+		if( !solveWings() ) {
+			return -1;
+		}
+	}
+	if( !finish() ) {
+		return -1;
+	}
+	return cube->isSolved() ? count : -1;
+}
+
+void reductionSolver::fixWingParity() {
+	int n = dim - 1;
+	std::vector<int> cells;
+	for( int k = 1; k < n - k; k++ ) {
+		orbitCells( k, cells );
+		int size = (int)cells.size();
+		std::vector<int> wanted( size ), current( size );
+		for( int i = 0; i < size; i++ ) {
+			wanted[i] = wantedWing( cells[i] );
+			current[i] = wingId( cells[i] );
+		}
+
+		//Parity of the permutation taking each wing to its cell
+		int parity = 0;
+		std::vector<bool> seen( size, false );
+		for( int i = 0; i < size; i++ ) {
+			int length = 0;
+			for( int j = i; !seen[j]; length++ ) {
+				seen[j] = true;
+				int next = 0;
+				while( wanted[next] != current[j] ) {
+					next++;
+				}
+				j = next;
+			}
+			if( length ) {
+				parity ^= ( length - 1 ) & 1;
+			}
+		}
+
+		//A single inner slice turn is a 4-cycle of this orbit
+		if( parity ) {
+			emit( layerTurn( cubeModel::RIGHT, 1, k ) );
+		}
+	}
+}
+
+bool reductionSolver::solveCenters() {
+	static const int order[5] = { cubeModel::TOP, cubeModel::BOTTOM, cubeModel::FRONT, cubeModel::RIGHT, cubeModel::BACK };
+	int n = dim - 1;
+	bool solved[6] = { false, false, false, false, false, false };
+	const unsigned char * s = cube->getStickers();
+
+	//The last face is solved once the other five are
+	for( int o = 0; o < 5; o++ ) {
+		int face = order[o];
+		int color = colorOf[face];
+		for( int row = 1; row < n; row++ ) {
+			if( cancelled() ) {
+				return false;
+			}
+			for( int col = 1; col < n; col++ ) {
+				if( dim % 2 && row == dim / 2 && col == dim / 2 ) {
+					continue;
+				}
+				int t = cube->index( face, row, col );
+				while( s[t] != color ) {
+					bool placed = false;
+					for( int side = 0; side < 6 && !placed; side++ ) {
+						if( side != face && side != ( face ^ 1 ) && !solved[side] ) {
+							placed = placeCenter( face, t, color, side );
+						}
+					}
+					if( placed ) {
+						break;
+					}
+
+					//All pieces left are on the opposite face: move one onto
+					//an unsolved neighbour first
+					int rows[4] = { row, col, n - row, n - col };
+					int cols[4] = { col, n - row, n - col, row };
+					for( int side = 0; side < 6 && !placed; side++ ) {
+						if( side == face || side == ( face ^ 1 ) || solved[side] ) {
+							continue;
+						}
+						for( int r = 0; r < 4 && !placed; r++ ) {
+							int p = cube->index( side, rows[r], cols[r] );
+							if( s[p] != color ) {
+								placed = placeCenter( side, p, color, face ^ 1 );
+							}
+						}
+					}
+					if( !placed ) {
+						return false;
+					}
+				}
+			}
+		}
+		solved[face] = true;
+	}
+	return true;
+}
+
+bool reductionSolver::placeCenter( int target, int sticker, int color, int source ) {
+	int n = dim - 1;
+	const unsigned char * s = cube->getStickers();
+	frame f;
+	makeFrame( source, target, f );
+
+	//Turn the target face so the sticker lands where the commutator works
+	for( int q = 0; q < 4; q++ ) {
+		int moved = q ? cube->moveSticker( sticker, faceTurn( target, q ) ) : sticker;
+		int face, r, c;
+		unframeSticker( f, moved, face, r, c );
+		int b = n - r;
+		if( c == b ) {
+			continue;
+		}
+		int p[2] = { frameSticker( f, cubeModel::FRONT, r, c ), frameSticker( f, cubeModel::FRONT, c, b ) };
+
+		//Forward commutator takes p[0] to the target, inverse takes p[1];
+		//turning the source face brings the other pieces of the orbit there
+		for( int dir = 0; dir < 2; dir++ ) {
+			for( int k = 0; k < 4; k++ ) {
+				int from = k ? cube->moveSticker( p[dir], faceTurn( source, 4 - k ) ) : p[dir];
+				if( s[from] != color ) {
+					continue;
+				}
+				move seq[12], comm[8];
+				int length = 0;
+				if( k ) {
+					seq[length++] = faceTurn( source, k );
+				}
+				if( q ) {
+					seq[length++] = faceTurn( target, q );
+				}
+				centerCommutator( n, c, b, comm );
+				if( dir ) {
+					invert( comm, 8, seq + length );
+				}
+				else {
+					for( int i = 0; i < 8; i++ ) {
+						seq[length + i] = comm[i];
+					}
+				}
+				frameMoves( f, seq + length, 8 );
+				length += 8;
+				if( q ) {
+					seq[length++] = faceTurn( target, 4 - q );
+				}
+				if( k ) {
+					seq[length++] = faceTurn( source, 4 - k );
+				}
+				int other = k ? cube->moveSticker( p[dir ^ 1], faceTurn( source, 4 - k ) ) : p[dir ^ 1];
+				int stickers[3] = { sticker, from, other };
+				emitCycle( seq, length, stickers, 3 );
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void reductionSolver::fixCornerParity() {
+	if( dim % 2 ) {
+		return;
+	}
+	//Even cubes have no middle edges to absorb an odd corner permutation
+	const unsigned char * s = cube->getStickers();
+	int perm[8];
+	for( int k = 0; k < 8; k++ ) {
+		int mask = 0;
+		for( int t = 0; t < 3; t++ ) {
+			mask |= 1 << home[s[cube->slotSticker( cubeModel::cornerSlots[k][t] )]];
+		}
+		for( int j = 0; j < 8; j++ ) {
+			int slot = 0;
+			for( int t = 0; t < 3; t++ ) {
+				slot |= 1 << cubeModel::cornerSlots[j][t][0];
+			}
+			if( slot == mask ) {
+				perm[k] = j;
+			}
+		}
+	}
+	int parity = 0;
+	for( int i = 0; i < 8; i++ ) {
+		for( int j = i + 1; j < 8; j++ ) {
+			parity ^= perm[j] < perm[i];
+		}
+	}
+	if( parity ) {
+		emit( faceTurn( cubeModel::TOP, 1 ) );
+	}
+}
+
+bool reductionSolver::solveWings() {
+	int n = dim - 1;
+	for( int k = 1; k < n - k; k++ ) {
+		if( cancelled() || !solveWingOrbit( k ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool reductionSolver::solveWingOrbit( int k ) {
+	std::vector<int> cells;
+	orbitCells( k, cells );
+	int size = (int)cells.size();
+	std::vector<int> wanted( size );
+	std::vector<bool> done( size, false );
+	for( int i = 0; i < size; i++ ) {
+		wanted[i] = wantedWing( cells[i] );
+	}
+
+	//One cell of every slot first, so the last three cells left are in
+	//different slots and a single 3-cycle can finish the orbit
+	for( int n = 0; n < size; n++ ) {
+		int i = n % 12 * 2 + n / 12;
+		if( wingId( cells[i] ) != wanted[i] ) {
+			int from = -1;
+			for( int j = 0; j < size && from < 0; j++ ) {
+				if( !done[j] && j != i && wingId( cells[j] ) == wanted[i] ) {
+					from = j;
+				}
+			}
+			if( from < 0 ) {
+				return false;
+			}
+			if( from / 2 == i / 2 ) {
+				//Outer turns keep the two cells of a slot together, so no
+				//setup puts both in one 3-cycle: move the wing out first
+				int via = -1;
+				for( int j = 0; j < size && via < 0; j++ ) {
+					if( !done[j] && j / 2 != i / 2 && placeWing( cells[from], cells[j], cells, done ) ) {
+						via = j;
+					}
+				}
+				if( via < 0 ) {
+					return false;
+				}
+				from = via;
+			}
+			if( !placeWing( cells[from], cells[i], cells, done ) ) {
+				return false;
+			}
+		}
+		done[i] = true;
+	}
+	return true;
+}
+
+bool reductionSolver::placeWing( int from, int to, const std::vector<int> & cells, const std::vector<bool> & done ) {
+	long long numCells = (long long)dim * dim * dim;
+	for( size_t i = 0; i < setups.size(); i++ ) {
+		const setup & x = setups[i];
+		int a = from, b = to;
+		for( int m = 0; m < x.length; m++ ) {
+			a = moveCell( a, x.moves[m] );
+			b = moveCell( b, x.moves[m] );
+		}
+		std::map<long long, std::vector<wingCycle> >::const_iterator it = cycles.find( a * numCells + b );
+		if( it == cycles.end() ) {
+			continue;
+		}
+		for( size_t w = 0; w < it->second.size(); w++ ) {
+			const wingCycle & cycle = it->second[w];
+
+			//The third wing must not be one already placed
+			int third = cycle.cells[2];
+			for( int m = x.length - 1; m >= 0; m-- ) {
+				third = moveCell( third, cubeModel::inverse( x.moves[m] ) );
+			}
+			size_t j = 0;
+			while( j < cells.size() && cells[j] != third ) {
+				j++;
+			}
+			if( j == cells.size() || done[j] ) {
+				continue;
+			}
+
+			move seq[14], comm[8];
+			int length = 0;
+			for( int m = 0; m < x.length; m++ ) {
+				seq[length++] = x.moves[m];
+			}
+			wingCommutator( dim - 1, cycle.column, comm );
+			if( cycle.inverse ) {
+				invert( comm, 8, seq + length );
+			}
+			else {
+				for( int m = 0; m < 8; m++ ) {
+					seq[length + m] = comm[m];
+				}
+			}
+			frameMoves( frames[cycle.frame], seq + length, 8 );
+			length += 8;
+			length += invert( x.moves, x.length, seq + length );
+
+			int stickers[6];
+			cellStickers( from, stickers );
+			cellStickers( to, stickers + 2 );
+			cellStickers( third, stickers + 4 );
+			emitCycle( seq, length, stickers, 6 );
+			return true;
+		}
+	}
+	return false;
+}
+
+bool reductionSolver::finish() {
+	//The reduced cube is a 3x3 made of corners, edge and center blocks
+	cubeModel small( 3 );
+	int scale[3] = { 0, dim / 2, dim - 1 };
+	for( int f = 0; f < 6; f++ ) {
+		for( int r = 0; r < 3; r++ ) {
+			for( int c = 0; c < 3; c++ ) {
+				small.set( f, r, c, cube->get( f, scale[r], scale[c] ) );
+			}
+		}
+	}
+	move moves[32];
+	int length = finisher.solve( small, moves, 21, cancel );
+	if( length < 0 ) {
+		return false;
+	}
+	for( int i = 0; i < length; i++ ) {
+		emit( moves[i] );
+	}
+	return true;
+}
+
+int reductionSolver::wingId( int cell ) const {
+	int s[2];
+	cellStickers( cell, s );
+	const unsigned char * colors = cube->getStickers();
+	int area = dim * dim;
+	return wingId( cell, s[0] / area, colors[s[0]], s[1] / area, colors[s[1]] );
+}
+
+int reductionSolver::wingId( int cell, int faceA, int colorA, int faceB, int colorB ) const {
+	int homeA = home[colorA], homeB = home[colorB];
+	int e = edgeFromFaces( homeA, homeB );
+	if( e < 0 ) {
+		return -1;
+	}
+	//Which of the slot's two wings: the side of the middle the wing is on,
+	//along the edge direction taken from its colors
+	if( homeA > homeB ) {
+		int swap = faceA;
+		faceA = faceB;
+		faceB = swap;
+	}
+	int u[3], v[3];
+	cubeModel::normal( faceA, u[0], u[1], u[2] );
+	cubeModel::normal( faceB, v[0], v[1], v[2] );
+	int p[3] = { cell / ( dim * dim ), cell / dim % dim, cell % dim };
+	int side = 0;
+	for( int i = 0; i < 3; i++ ) {
+		int d = u[( i + 1 ) % 3] * v[( i + 2 ) % 3] - u[( i + 2 ) % 3] * v[( i + 1 ) % 3];
+		side += d * ( 2 * p[i] - ( dim - 1 ) );
+	}
+	return e * 2 + ( side > 0 );
+}
+
+int reductionSolver::wantedWing( int cell ) const {
+	int s[2];
+	cellStickers( cell, s );
+	int area = dim * dim;
+	int faceA = s[0] / area, faceB = s[1] / area;
+	if( dim % 2 == 0 ) {
+		return wingId( cell, faceA, colorOf[faceA], faceB, colorOf[faceB] );
+	}
+	//Middle edge of the same slot
+	int p[3] = { cell / area, cell / dim % dim, cell % dim };
+	for( int i = 0; i < 3; i++ ) {
+		if( p[i] != 0 && p[i] != dim - 1 ) {
+			p[i] = dim / 2;
+		}
+	}
+	int m[2];
+	cellStickers( ( p[0] * dim + p[1] ) * dim + p[2], m );
+	const unsigned char * colors = cube->getStickers();
+	return wingId( cell, faceA, colors[m[0]], faceB, colors[m[1]] );
+}
+
+//Cells are listed slot by slot, two per slot
+void reductionSolver::orbitCells( int k, std::vector<int> & cells ) const {
+	int n = dim - 1;
+	cells.clear();
+	for( int e = 0; e < 12; e++ ) {
+		int u[3], v[3];
+		cubeModel::normal( cubeModel::edgeSlots[e][0][0], u[0], u[1], u[2] );
+		cubeModel::normal( cubeModel::edgeSlots[e][1][0], v[0], v[1], v[2] );
+		for( int side = 0; side < 2; side++ ) {
+			int p[3];
+			for( int i = 0; i < 3; i++ ) {
+				int d = u[i] + v[i];
+				p[i] = d > 0 ? n : d < 0 ? 0 : ( side ? n - k : k );
+			}
+			cells.push_back( ( p[0] * dim + p[1] ) * dim + p[2] );
+		}
+	}
+}
+
+void reductionSolver::buildCycles() {
+	int n = dim - 1;
+	cycles.clear();
+	for( int f = 0; f < 24; f++ ) {
+		const frame & fr = frames[f];
+		for( int c = 1; c < n; c++ ) {
+			if( c == n - c ) {
+				continue;
+			}
+			//Canonical cells: Top-Front, Top-Back, Back-Right at column c
+			int canon[3][3] = { { c, n, n }, { c, n, 0 }, { n, c, 0 } };
+			int cells[3];
+			for( int i = 0; i < 3; i++ ) {
+				int x, y, z;
+				frameCell( fr, canon[i][0], canon[i][1], canon[i][2], x, y, z );
+				cells[i] = ( x * dim + y ) * dim + z;
+			}
+			for( int inv = 0; inv < 2; inv++ ) {
+				move comm[8], seq[8];
+				wingCommutator( n, c, comm );
+				if( inv ) {
+					invert( comm, 8, seq );
+				}
+				else {
+					for( int i = 0; i < 8; i++ ) {
+						seq[i] = comm[i];
+					}
+				}
+				frameMoves( fr, seq, 8 );
+				for( int i = 0; i < 3; i++ ) {
+					int dest = cells[i];
+					for( int m = 0; m < 8; m++ ) {
+						dest = moveCell( dest, seq[m] );
+					}
+					wingCycle w;
+					w.cells[0] = cells[i];
+					w.cells[1] = dest;
+					w.cells[2] = cells[0] + cells[1] + cells[2] - cells[i] - dest;
+					w.frame = f;
+					w.column = c;
+					w.inverse = inv != 0;
+					cycles[cells[i] * (long long)dim * dim * dim + dest].push_back( w );
+				}
+			}
+		}
+	}
+	cycleDim = dim;
+}
+
+void reductionSolver::emit( move m ) {
+	cube->apply( m );
+	if( sink ) {
+		sink( m, data );
+	}
+	count++;
+}
+
+void reductionSolver::emitCycle( const move * moves, int length, const int * stickers, int numStickers ) {
+	unsigned char * s = cube->getStickers();
+	int dest[8];
+	unsigned char colors[8];
+	for( int i = 0; i < numStickers; i++ ) {
+		int d = stickers[i];
+		for( int m = 0; m < length; m++ ) {
+			d = cube->moveSticker( d, moves[m] );
+		}
+		dest[i] = d;
+		colors[i] = s[stickers[i]];
+	}
+	for( int i = 0; i < numStickers; i++ ) {
+		s[dest[i]] = colors[i];
+	}
+	if( sink ) {
+		for( int m = 0; m < length; m++ ) {
+			sink( moves[m], data );
+		}
+	}
+	count += length;
+}
+
+void reductionSolver::makeFrame( int front, int top, frame & f ) const {
+	int y[3], z[3];
+	cubeModel::normal( top, y[0], y[1], y[2] );
+	cubeModel::normal( front, z[0], z[1], z[2] );
+	for( int i = 0; i < 3; i++ ) {
+		f.rot[i][0] = y[( i + 1 ) % 3] * z[( i + 2 ) % 3] - y[( i + 2 ) % 3] * z[( i + 1 ) % 3];
+		f.rot[i][1] = y[i];
+		f.rot[i][2] = z[i];
+	}
+	for( int face = 0; face < 6; face++ ) {
+		int v[3], w[3];
+		cubeModel::normal( face, v[0], v[1], v[2] );
+		for( int i = 0; i < 3; i++ ) {
+			w[i] = f.rot[i][0] * v[0] + f.rot[i][1] * v[1] + f.rot[i][2] * v[2];
+		}
+		f.faces[face] = cubeModel::faceFromNormal( w[0], w[1], w[2] );
+	}
+}
+
+void reductionSolver::frameMoves( const frame & f, move * moves, int length ) const {
+	//Layers and quarter turns are counted from the face, so only the face changes
+	for( int i = 0; i < length; i++ ) {
+		move m = moves[i];
+		moves[i] = cubeModel::makeMove( f.faces[cubeModel::moveFace( m )], cubeModel::moveQuarters( m ),
+			cubeModel::moveFirst( m ), cubeModel::moveLast( m ) );
+	}
+}
+
+void reductionSolver::frameCell( const frame & f, int x, int y, int z, int & outX, int & outY, int & outZ ) const {
+	//Rotate about the cube center, in doubled coordinates to stay integral
+	int n = dim - 1;
+	int u[3] = { 2 * x - n, 2 * y - n, 2 * z - n };
+	int w[3];
+	for( int i = 0; i < 3; i++ ) {
+		w[i] = f.rot[i][0] * u[0] + f.rot[i][1] * u[1] + f.rot[i][2] * u[2];
+	}
+	outX = ( w[0] + n ) / 2;
+	outY = ( w[1] + n ) / 2;
+	outZ = ( w[2] + n ) / 2;
+}
+
+int reductionSolver::frameSticker( const frame & f, int face, int row, int col ) const {
+	int x, y, z;
+	cube->position( face, row, col, x, y, z );
+	frameCell( f, x, y, z, x, y, z );
+	return cube->stickerAt( f.faces[face], x, y, z );
+}
+
+void reductionSolver::unframeSticker( const frame & f, int sticker, int & face, int & row, int & col ) const {
+	int n = dim - 1;
+	int actual = sticker / ( dim * dim );
+	int p[3];
+	cube->position( actual, sticker / dim % dim, sticker % dim, p[0], p[1], p[2] );
+
+	//Inverse rotation is the transpose
+	int u[3] = { 2 * p[0] - n, 2 * p[1] - n, 2 * p[2] - n };
+	int w[3];
+	for( int i = 0; i < 3; i++ ) {
+		w[i] = ( f.rot[0][i] * u[0] + f.rot[1][i] * u[1] + f.rot[2][i] * u[2] + n ) / 2;
+	}
+	for( face = 0; f.faces[face] != actual; face++ ) {
+	}
+	int index = cube->stickerAt( face, w[0], w[1], w[2] );
+	row = index / dim % dim;
+	col = index % dim;
+}
+
+int reductionSolver::cellOf( int sticker ) const {
+	int x, y, z;
+	cube->position( sticker / ( dim * dim ), sticker / dim % dim, sticker % dim, x, y, z );
+	return ( x * dim + y ) * dim + z;
+}
+
+int reductionSolver::moveCell( int cell, move m ) const {
+	int s[2];
+	cellStickers( cell, s );
+	return cellOf( cube->moveSticker( s[0], m ) );
+}
+
+void reductionSolver::cellStickers( int cell, int * out ) const {
+	int n = dim - 1;
+	int x = cell / ( dim * dim ), y = cell / dim % dim, z = cell % dim;
+	int count = 0;
+	if( x == 0 ) {
+		out[count++] = cube->stickerAt( cubeModel::LEFT, x, y, z );
+	}
+	if( x == n ) {
+		out[count++] = cube->stickerAt( cubeModel::RIGHT, x, y, z );
+	}
+	if( y == 0 && count < 2 ) {
+		out[count++] = cube->stickerAt( cubeModel::BOTTOM, x, y, z );
+	}
+	if( y == n && count < 2 ) {
+		out[count++] = cube->stickerAt( cubeModel::TOP, x, y, z );
+	}
+	if( z == 0 && count < 2 ) {
+		out[count++] = cube->stickerAt( cubeModel::BACK, x, y, z );
+	}
+	if( z == n && count < 2 ) {
+		out[count++] = cube->stickerAt( cubeModel::FRONT, x, y, z );
+	}
+}
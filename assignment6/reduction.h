@@ -0,0 +1,178 @@
+//Header file for Rubiks cube project
+#ifndef REDUCTION_H
+#define REDUCTION_H
+#include "cubeModel.h"
+#include "kociemba.h"
+#include <atomic>
+#include <map>
+#include <vector>
+
+/*
+ * Reduction solver for cubes of any size from 3x3 up.
+ *
+ * The cube is reduced to a 3x3 in three steps:
+ *  - wing parity is fixed with one slice turn per wing orbit that needs it
+ *  - the centers are solved face by face with center 3-cycles
+ *  - the wings are paired with the middle edges (odd sizes) or solved
+ *    outright (even sizes) with wing 3-cycles
+ * and the remaining 3x3 is finished by the two-phase solver.
+ *
+ * The 3-cycles are commutators whose net effect is known, so the working
+ * copy of the cube only moves the three pieces involved and never turns
+ * whole layers for them.  Moves are handed to a callback as they are
+ * found; nothing but the working copy grows with the cube, so memory use
+ * is O(dim^2) even for solutions of millions of moves.
+ */
+class reductionSolver {
+public:
+	/*
+	 * Receives each move of the solution in order.
+	 */
+	typedef void (*moveSink)( cubeModel::move m, void * data );
+
+	/*
+	 * Constructor.  The two-phase solver must be loaded before solving.
+	 */
+	reductionSolver( const kociembaSolver & finisher );
+
+	/*
+	 * Destructor
+	 */
+	~reductionSolver();
+
+	/*
+	 * Solves a sticker state, passing every move to sink.  Returns the
+	 * number of moves, or -1 if the state is invalid or smaller than 3x3.
+	 */
+	long solve( const cubeModel & state, moveSink sink, void * data );
+
+	/*
+	 * Flag another thread sets to stop a running solve, which then
+	 * returns -1.  NULL (the default) for none.
+	 */
+	void setCancel( const std::atomic<bool> * flag ) { cancel = flag; }
+
+private:
+	/*
+	 * A whole cube rotation given by where it sends the front and top
+	 * faces.  Used to place the canonical commutators anywhere on the cube.
+	 */
+	struct frame {
+		int rot[3][3];	//Rotation matrix, columns are the images of x, y, z
+		int faces[6];	//Image of each face
+	};
+
+	/*
+	 * One wing 3-cycle in actual cube cells: the wing in cells[0] moves
+	 * to cells[1], cells[1] to cells[2] and cells[2] to cells[0].
+	 */
+	struct wingCycle {
+		int cells[3];
+		int frame;
+		int column;
+		bool inverse;
+	};
+
+	/*
+	 * Outer face turns used to bring wings into a 3-cycle.
+	 */
+	struct setup {
+		int length;
+		cubeModel::move moves[3];
+	};
+
+	const kociembaSolver & finisher;
+	cubeModel * cube;	//Working copy
+	int dim;
+	moveSink sink;
+	void * data;
+	long count;
+	const std::atomic<bool> * cancel;
+	int home[6];	//Face each color belongs on
+	int colorOf[6];	//Color each face is solved to
+
+	frame frames[24];
+	std::vector<setup> setups;	//All setups up to 3 moves, shortest first
+	std::map<long long, std::vector<wingCycle> > cycles;	//Wing 3-cycles by (from, to) cell
+	int cycleDim;	//Dimensions the cycles were built for
+
+	/*
+	 * Returns whether the solve has been cancelled.
+	 */
+	bool cancelled() const { return cancel && cancel->load( std::memory_order_relaxed ); }
+
+	//Steps
+	void fixWingParity();
+	bool solveCenters();
+	void fixCornerParity();
+	bool solveWings();
+	bool finish();
+
+	/*
+	 * Moves a piece of the given color into sticker on face target,
+	 * taking it from face source.  Returns false if source has no such
+	 * piece in the sticker's orbit.
+	 */
+	bool placeCenter( int target, int sticker, int color, int source );
+
+	/*
+	 * Solves one orbit of 24 wings (offset k from a corner).  Returns
+	 * false if a wing could not be placed.
+	 */
+	bool solveWingOrbit( int k );
+
+	/*
+	 * Finds setup moves and a wing 3-cycle moving the wing in cell from to
+	 * cell to, with the third cell not done.  Emits it and returns true.
+	 */
+	bool placeWing( int from, int to, const std::vector<int> & cells, const std::vector<bool> & done );
+
+	/*
+	 * Wing identity (0-23) of the wing in a cell, or of the given colors
+	 * placed on the cell's two faces.
+	 */
+	int wingId( int cell ) const;
+	int wingId( int cell, int faceA, int colorA, int faceB, int colorB ) const;
+
+	/*
+	 * Wing identity that belongs in a cell: matching the middle edge in
+	 * the same slot on odd cubes, the face colors on even cubes.
+	 */
+	int wantedWing( int cell ) const;
+
+	/*
+	 * The 24 cells of wing orbit k.
+	 */
+	void orbitCells( int k, std::vector<int> & cells ) const;
+
+	/*
+	 * Builds the wing 3-cycle lookup for the current dimensions.
+	 */
+	void buildCycles();
+
+	/*
+	 * Outputs and applies one move.
+	 */
+	void emit( cubeModel::move m );
+
+	/*
+	 * Outputs a sequence whose net effect only permutes the given stickers
+	 * and moves just those stickers in the working copy.
+	 */
+	void emitCycle( const cubeModel::move * moves, int length, const int * stickers, int numStickers );
+
+	//Geometry
+	void makeFrame( int front, int top, frame & f ) const;
+	void frameMoves( const frame & f, cubeModel::move * moves, int length ) const;
+	int frameSticker( const frame & f, int face, int row, int col ) const;
+	void frameCell( const frame & f, int x, int y, int z, int & outX, int & outY, int & outZ ) const;
+	void unframeSticker( const frame & f, int sticker, int & face, int & row, int & col ) const;
+	int cellOf( int sticker ) const;
+	int moveCell( int cell, cubeModel::move m ) const;
+	void cellStickers( int cell, int * out ) const;
+
+	//Not copyable
+	reductionSolver( const reductionSolver & );
+	reductionSolver & operator=( const reductionSolver & );
+};
+#endif
@@ -1,30 +1,96 @@
 #include "rubiksCube.h"
+#include "moveParser.h"
+#include "bidirectional.h"
+#include "cosets.h"
+#include "kociemba.h"
+#include "layerSolver.h"
+#include "lastLayer.h"
+#include "optimal.h"
+#include "pocket.h"
+#include "pruneTable.h"
+#include "reduction.h"
+#include "scrambler.h"
+#include "solveServer.h"
+#include "solverThread.h"
+#include "cubeValidator.h"
 #include "Camera.h" 
+#include "RenderQueue.h"
 #include "TextureCube.h"
+#include "UniformBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 
 Camera * camera = new Camera( vec3( 0.9, 0.9, 2.0 ) );
 
 rubiksCube * cube;
 
+// two-phase solver for 3x3 cubes, tables loaded on first use
+kociembaSolver solver;
+const char * solverTables = "kociemba.tables";
+
+// shortest solutions for 3x3 cubes a few moves from solved
+bidirectionalSolver nearSolver;
+const int nearLength = 10;
+
+// OLL and PLL cases for 3x3 last layer hints, built on the solver thread
+// when the two-phase tables load and only read once lastLayerBuilt is set
+lastLayer lastLayerCases;
+std::atomic<bool> lastLayerBuilt( false );
+
+// complete distance table for 2x2 cubes, loaded on first use
+pocketSolver pocket;
+const char * pocketTables = "pocket.tables";
+
+// reduction solver for 4x4 and up, finishes with the two-phase solver
+reductionSolver reducer( solver );
+
+// random-state scrambles for 2x2 and 3x3, random turns for larger cubes
+scrambler scrambles( solver, pocket );
+unsigned int scrambleSeed;	// seed of the next scramble
+
+// runs solves in the background, results are picked up by tick()
+solverThread solving;
+int solveEdits;		// cube edits when the running solve was submitted
+long solveMoves;	// moves of the running solve queued so far
+bool scrambling;	// running job is a scramble, not a solve
+
+// milliseconds a 3x3 solve may spend looking for shorter solutions
+const int solveBudget = 500;
+
 VertexArray * skybox;
 Shader * skyShader;
 TextureCube * skyboxTexture;
 mat4 skyModel;
 
-// elapsed time
-int elapsedTime;
+// camera matrices shared by all shaders, updated once per frame
+UniformBuffer * cameraBlock;
+
+// draws of a frame, submitted sorted by state
+RenderQueue * renderQueue;
+RenderQueue::Stats renderStats;
 
 // frame rate in millis for 30 frames/sec
 const int frameRate = 1000.0 / 30;
 
+// frame timer is running?  It stops while nothing changes
+bool ticking = false;
+
 
 void init( int dimensions ) {
 	camera->LookLeft( 25 );
 	camera->LookDown( 25 );
 	camera->MoveForward( 1.5 );
 
-	elapsedTime = 0;
+	cameraBlock = new UniformBuffer( Shader::CAMERA_BLOCK_BINDING, 2 * sizeof( mat4 ) );
 
 	/* Skybox Initialization */
 	skyboxTexture = new TextureCube(
@@ -39,8 +105,15 @@ void init( int dimensions ) {
 	skybox->AddAttribute( "vPosition", sky.getVertices(), sky.getNumVertices() );
 	skyModel = Scale( 5.0 );
 	skyShader= new Shader( "vshader_cube_tex.glsl", "fshader_cube_tex.glsl" );
+
+	//The sky never moves and always uses texture unit 1
+	skyShader->Bind();
+	skyShader->SetUniform( "model", skyModel );
+	skyShader->SetUniform( "textureCube", 1 );
+	skyShader->Unbind();
 		
 	cube = new rubiksCube( dimensions );
+	renderQueue = new RenderQueue();
 
 	glEnable( GL_DEPTH_TEST );
 	glClearColor( 1.0, 1.0, 1.0, 1.0 );
@@ -49,24 +122,214 @@ void init( int dimensions ) {
 void display() {
 	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-	/* Skybox processing */
-	skyboxTexture->Bind( 1 );
-	skyShader->Bind();
-	skyShader->SetUniform( "model", skyModel );
-	skyShader->SetUniform( "view", camera->GetView() );
-	skyShader->SetUniform( "projection", camera->GetProjection() );
-	skyShader->SetUniform( "textureCube", skyboxTexture->GetTextureUnit() );
-	skybox->Bind( *skyShader );
-	skybox->Draw( GL_TRIANGLES );
-	skybox->Unbind();
-	skyShader->Unbind();
-
-	cube->displayCube( camera->GetView(), camera->GetProjection() );
+	//Matches the Camera block in the vertex shaders
+	mat4 frame[2] = { camera->GetView(), camera->GetProjection() };
+	cameraBlock->Update( frame, sizeof( frame ) );
+
+	renderQueue->Add( skyShader, skybox, GL_TRIANGLES, 0, skyboxTexture, 1 );
+	cube->displayCube( *renderQueue, camera->GetPosition() );
+	renderQueue->Submit();
+
+	//Show the frame's draws and binds in the title when they change
+	const RenderQueue::Stats & stats = renderQueue->GetStats();
+	if( stats.draws != renderStats.draws || stats.programBinds != renderStats.programBinds ||
+			stats.vertexArrayBinds != renderStats.vertexArrayBinds || stats.textureBinds != renderStats.textureBinds ) {
+		renderStats = stats;
+		char title[128];
+		sprintf( title, "Rubik's cube - %d draws, %d programs, %d vertex arrays, %d textures bound",
+			stats.draws, stats.programBinds, stats.vertexArrayBinds, stats.textureBinds );
+		glutSetWindowTitle( title );
+	}
 
 	glutSwapBuffers();
 }
 
 
+//Move sink for the reduction solver: hands each move to the main thread
+void streamMove( cubeModel::move m, void * data ) {
+	( (solverThread *)data )->stream( &m, 1 );
+}
+
+/*
+ * Loads the two-phase tables on first use, then builds the last layer
+ * cases (about a second, once) for the hint key.
+ */
+bool loadSolver( solverThread & worker ) {
+	if( !solver.isLoaded() ) {
+		worker.setProgress( "Loading two-phase tables" );
+		if( !solver.load( solverTables ) ) {
+			return false;
+		}
+	}
+	if( !lastLayerBuilt ) {
+		worker.setProgress( "Building last layer cases" );
+		lastLayerCases.build( solver );
+		lastLayerBuilt = true;
+	}
+	return true;
+}
+
+/*
+ * Solve job, runs on the solver thread.  Tables are loaded on first use.
+ * 2x2 cubes are solved from the distance table and 4x4 and up by
+ * reduction, whose moves are streamed as they are found.  A 3x3 close to
+ * solved gets a shortest solution from the bidirectional search; any
+ * other takes the two-phase solver's first solution and then keeps
+ * looking for shorter ones until the solve is cancelled.
+ */
+bool solveJob( const cubeModel & state, solverThread & worker ) {
+	int dim = state.getDimensions();
+	cubeModel::move moves[64];
+	char text[64];
+	if( dim == 2 ) {
+		if( !pocket.isLoaded() ) {
+			worker.setProgress( "Loading 2x2 table" );
+			if( !pocket.load( pocketTables ) ) {
+				return false;
+			}
+		}
+		int length = pocket.solve( state, moves );
+		if( length < 0 ) {
+			return false;
+		}
+		worker.setBest( moves, length );
+		return true;
+	}
+
+	if( !loadSolver( worker ) ) {
+		return false;
+	}
+	if( dim > 3 ) {
+		reducer.setCancel( worker.getCancelFlag() );
+		return reducer.solve( state, streamMove, &worker ) >= 0;
+	}
+
+	int length = nearSolver.solve( state, moves, nearLength );
+	if( length >= 0 ) {
+		sprintf( text, "Shortest solution: %d moves", length );
+		worker.setProgress( text );
+		worker.setBest( moves, length );
+		return true;
+	}
+	//Any solution within 22 moves comes fastest, the loop then shortens it
+	length = solver.solve( state, moves, 22, worker.getCancelFlag() );
+	if( length < 0 ) {
+		return false;
+	}
+	while( length >= 0 ) {
+		sprintf( text, "Found %d moves, looking for shorter", length );
+		worker.setProgress( text );
+		worker.setBest( moves, length );
+		length = length > 0 ? solver.solve( state, moves, length - 1, worker.getCancelFlag() ) : -1;
+	}
+	return true;
+}
+
+/*
+ * Scramble job, runs on the solver thread since the first 2x2 or 3x3
+ * scramble loads (or builds) the solver tables.
+ */
+bool scrambleJob( const cubeModel & state, solverThread & worker ) {
+	int dim = state.getDimensions();
+	if( dim == 2 && !pocket.isLoaded() ) {
+		worker.setProgress( "Loading 2x2 table" );
+		if( !pocket.load( pocketTables ) ) {
+			return false;
+		}
+	}
+	if( dim == 3 && !loadSolver( worker ) ) {
+		return false;
+	}
+	std::vector<cubeModel::move> moves;
+	if( !scrambles.scramble( dim, scrambleSeed++, moves ) ) {
+		return false;
+	}
+	worker.setBest( moves.empty() ? NULL : &moves[0], (int)moves.size() );
+	return true;
+}
+
+//Table build progress, reported by the solve job that needs the tables
+void tableProgress( const pruneTable::Progress & p, void * data ) {
+	char text[96];
+	sprintf( text, "Building %s table: depth %d, %.0f%% done", p.name, p.depth, 100.0 * p.filled / p.size );
+	( (solverThread *)data )->setProgress( text );
+}
+
+/*
+ * Queues the moves the solver thread has ready and prints its progress.
+ * Stops a 3x3 solve once it is over its time budget and drops a solve
+ * whose cube was changed in the meantime.  A finished scramble is
+ * applied at once.
+ */
+void pollSolver() {
+	std::string text;
+	if( solving.getProgress( text ) ) {
+		std::cout << text << std::endl;
+	}
+	if( scrambling ) {
+		std::vector<cubeModel::move> moves;
+		solverThread::Status status = solving.poll( moves );
+		if( status == solverThread::FINISHED ) {
+			cube->scramble( moves.empty() ? NULL : &moves[0], (int)moves.size() );
+			std::cout << "Scrambled with " << moves.size() << " moves" << std::endl;
+		}
+		else if( status == solverThread::FAILED ) {
+			std::cout << "Could not scramble" << std::endl;
+		}
+		return;
+	}
+	if( cube->getEdits() != solveEdits ) {
+		solving.discard();
+	}
+	else if( cube->getDimensions() == 3 && solving.getElapsed() > solveBudget ) {
+		solving.cancel();
+	}
+
+	std::vector<cubeModel::move> moves;
+	solverThread::Status status = solving.poll( moves );
+	if( !moves.empty() ) {
+		cube->queueMoves( &moves[0], (int)moves.size() );
+		solveMoves += (long)moves.size();
+	}
+	if( status == solverThread::FINISHED ) {
+		std::cout << "Solving in " << solveMoves << " moves" << std::endl;
+	}
+	else if( status == solverThread::FAILED ) {
+		std::cout << "No solution found" << std::endl;
+	}
+}
+
+/*
+ * Frame timer: picks up solver results and animates the cube, and only
+ * redraws when the cube changed.  It keeps running while the cube moves
+ * or a job runs and stops after that, so an idle window draws nothing
+ * until the next key or window event.
+ */
+void tick( int value )
+{
+	if( solving.isBusy() ) {
+		pollSolver();
+	}
+	bool redraw = cube->update();
+	if( redraw ) {
+		glutPostRedisplay();
+	}
+	ticking = redraw || solving.isBusy();
+	if( ticking ) {
+		glutTimerFunc( frameRate, tick, 0 );
+	}
+}
+
+//Starts the frame timer after something that may change the cube
+void wake()
+{
+	if( !ticking ) {
+		ticking = true;
+		glutTimerFunc( frameRate, tick, 0 );
+	}
+}
+
+
 void keyboard( unsigned char key, int x, int y ) {
 	int temp;
 	switch( key ) {
@@ -76,30 +339,38 @@ void keyboard( unsigned char key, int x, int y ) {
 			exit( EXIT_SUCCESS );
 			break; 
 
-		//Camera Controls
+		//Camera Controls, only these redraw at once
 		case 'i':   // forward
 			camera->MoveForward(0.5);
+			glutPostRedisplay();
 			break;
 		case 'j':
 		camera->LookLeft(5);
+		glutPostRedisplay();
 		break;
 	  case 'k':   
 		camera->MoveBackward(0.5);
+		glutPostRedisplay();
 		break;
 	  case 'l':
 		camera->LookRight(5);
+		glutPostRedisplay();
 		break;
 	  case 'p':
 		camera->MoveUp(0.5);
+		glutPostRedisplay();
 		break;
 	  case ';':
 		camera->MoveDown(0.5);
+		glutPostRedisplay();
 		break;
 	  case '9':
 		camera->LookUp(5);
+		glutPostRedisplay();
 		break;
 	  case '8':
 		camera->LookDown(5);
+		glutPostRedisplay();
 		break;
 
 	/*Cube Controls*/
@@ -141,14 +412,78 @@ void keyboard( unsigned char key, int x, int y ) {
 			cube->isWin();
 			break;
 
-		//scramble
+		//Solve, or take the best solution so far if already solving
+		case 'x':
+			if( solving.isBusy() ) {
+				solving.cancel();
+			}
+			else if( cube->getDimensions() < 2 ) {
+				std::cout << "Nothing to solve" << std::endl;
+			}
+			else if( !cube->isMoving() ) {
+				cubeModel state( cube->getDimensions() );
+				cube->getState( state );
+				solveEdits = cube->getEdits();
+				solveMoves = 0;
+				scrambling = false;
+				solving.submit( state, solveJob );
+			}
+			break;
+
+		//Hint: next layer by layer step, its first layer highlighted.  The
+		//last layer gets OLL and PLL once a solve or scramble built them
+		case 'n':
+			if( cube->getDimensions() != 3 ) {
+				std::cout << "Hints are for 3x3 cubes" << std::endl;
+			}
+			else if( !cube->isMoving() ) {
+				cubeModel state( 3 );
+				cube->getState( state );
+				std::vector<cubeModel::move> moves;
+				layerSolver::Stage stage;
+				if( !layerSolver::nextStep( state, moves, stage ) ) {
+					std::cout << "Not a valid cube" << std::endl;
+				}
+				else if( stage == layerSolver::SOLVED ) {
+					std::cout << "Already solved" << std::endl;
+				}
+				else {
+					//Past the first two layers the last layer takes one OLL and one PLL
+					char text[32];
+					std::string name = layerSolver::stageName( stage );
+					lastLayer::Hint hint;
+					if( stage >= layerSolver::ORIENT_EDGES && lastLayerBuilt && cube->getHint( lastLayerCases, hint ) ) {
+						static const char * steps[] = { "OLL", "PLL", "AUF" };
+						name = steps[hint.step];
+						if( hint.step != lastLayer::AUF ) {
+							sprintf( text, " %d", hint.number );
+							name += text;
+						}
+						moves = hint.moves;
+					}
+					std::cout << "Hint (" << name << "):";
+					for( size_t i = 0; i < moves.size(); i++ ) {
+						moveParser::format( moves[i], text );
+						std::cout << " " << text;
+					}
+					std::cout << std::endl;
+					cube->showHint( moves[0] );
+				}
+			}
+			break;
+
+		//scramble to a random state
 		case 'y':
-			cube->scramble();
+			if( !solving.isBusy() && cube->getDimensions() > 1 ) {
+				scrambling = true;
+				solving.submit( cubeModel( cube->getDimensions() ), scrambleJob );
+			}
 			break;
 		//Reset cube
 		case 'z':
 		case 'Z':
 			int dim = cube->getDimensions();
+			solving.discard();
 			delete cube;
 			cube = new rubiksCube( dim );
 			break;
@@ -156,7 +491,8 @@ void keyboard( unsigned char key, int x, int y ) {
 
 			
 	}
-	glutPostRedisplay();
+	//The cube redraws itself from the frame timer if the key changed it
+	wake();
 }
 
 void keyboardSpecial( int key, int x, int y ) {
@@ -178,23 +514,305 @@ void keyboardSpecial( int key, int x, int y ) {
 			cube->moveCursorLeft();
 			break;
 	}
-	glutPostRedisplay();
+	wake();
 }
 
-void idle( void )
-{
-	int now = glutGet(GLUT_ELAPSED_TIME);
-	if (now - elapsedTime > frameRate)
-	{
-		elapsedTime = now;
-		cube->update();
-		glutPostRedisplay();
+/*
+ * Replays a move file ("-" for stdin) onto the cube without animation.
+ * Moves are parsed and applied in batches as the file streams in.
+ */
+void replayMoves( const char * path ) {
+	FILE * in = strcmp( path, "-" ) ? fopen( path, "r" ) : stdin;
+	if( !in ) {
+		std::cerr << "Could not open " << path << std::endl;
+		return;
+	}
+	const int batchSize = 4096;
+	cubeModel::move batch[batchSize];
+	moveParser parser( in );
+	long total = 0;
+	int count;
+	int start = glutGet( GLUT_ELAPSED_TIME );
+	while( ( count = parser.next( batch, batchSize ) ) > 0 ) {
+		cube->applyMoves( batch, count );
+		total += count;
+	}
+	std::cout << "Replayed " << total << " moves in " 
+		<< glutGet( GLUT_ELAPSED_TIME ) - start << " ms" << std::endl;
+	if( parser.getErrors() ) {
+		std::cerr << parser.getErrors() << " invalid moves, first on line " 
+			<< parser.getErrorLine() << std::endl;
+	}
+	if( in != stdin ) {
+		fclose( in );
+	}
+}
+
+/*
+ * Move sink for -reduce: writes notation, twenty moves per line.
+ */
+struct moveWriter {
+	FILE * out;
+	long count;
+};
+
+void writeMove( cubeModel::move m, void * data ) {
+	moveWriter * writer = (moveWriter *)data;
+	char text[32];
+	moveParser::format( m, text );
+	fprintf( writer->out, ++writer->count % 20 ? "%s " : "%s\n", text );
+}
+
+/*
+ * Solves a cube without opening a window and writes the solution to
+ * stdout.  The cube is read from a move file ("-" for stdin), or
+ * scrambled with dim * 20 random layer turns which are written first, so
+ *	rubiks -reduce 100 | rubiks 100 -
+ * replays a scramble and its solution.
+ */
+int reduce( int dim, const char * path ) {
+	if( dim < 3 || !solver.load( solverTables ) ) {
+		return EXIT_FAILURE;
 	}
+	cubeModel state( dim );
+	moveWriter writer = { stdout, 0 };
+	if( path ) {
+		FILE * in = strcmp( path, "-" ) ? fopen( path, "r" ) : stdin;
+		if( !in ) {
+			std::cerr << "Could not open " << path << std::endl;
+			return EXIT_FAILURE;
+		}
+		moveParser::replay( in, state );
+		if( in != stdin ) {
+			fclose( in );
+		}
+	}
+	else {
+		srand( 1 );
+		printf( "# scramble\n" );
+		for( int i = 0; i < dim * 20; i++ ) {
+			int layer = rand() % dim;
+			cubeModel::move m = cubeModel::makeMove( rand() % 6, 1 + rand() % 3, layer, layer );
+			state.apply( m );
+			writeMove( m, &writer );
+		}
+		printf( "\n# solution\n" );
+		writer.count = 0;
+	}
+
+	clock_t start = clock();
+	long length = reducer.solve( state, writeMove, &writer );
+	printf( "\n" );
+	if( length < 0 ) {
+		cubeValidator::Result result = cubeValidator::validate( state );
+		std::cerr << "Could not solve: " << ( result != cubeValidator::VALID ? cubeValidator::describe( result ) : "no solution found" ) << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cerr << "Solved " << dim << "x" << dim << " in " << length << " moves, "
+		<< ( clock() - start ) * 1000 / CLOCKS_PER_SEC << " ms" << std::endl;
+	return EXIT_SUCCESS;
 }
 
+/*
+ * Loads the tables a dimension needs, the 2x2 table or the two-phase
+ * tables, with messages on stderr so stdout only carries results.
+ */
+bool loadTables( int dim ) {
+	pruneTable::setLog( stderr );
+	std::streambuf * console = std::cout.rdbuf( std::cerr.rdbuf() );
+	bool loaded = dim == 2 ? pocket.load( pocketTables ) : dim != 3 || solver.load( solverTables );
+	std::cout.rdbuf( console );
+	return loaded;
+}
+
+/*
+ * Runs the batch solver on stdin and stdout ("-") or on a UNIX domain
+ * socket.  Messages go to stderr so stdout only carries solutions.
+ */
+int serve( const char * path, int threads ) {
+	if( !loadTables( 3 ) ) {
+		return EXIT_FAILURE;
+	}
+	solveServer server( solver, threads );
+	if( strcmp( path, "-" ) ) {
+		return server.listen( path ) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+#ifdef _WIN32
+	_setmode( _fileno( stdin ), _O_BINARY );
+	_setmode( _fileno( stdout ), _O_BINARY );
+#endif
+	return server.serve( stdin, stdout ) >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Finds the phase 1 distance of a range of cosets with one worker process
+ * per shard, or runs one shard in a worker.  The tables are loaded (built
+ * if missing) before any workers start, so the workers only map them.
+ */
+int cosets( int argc, char ** argv ) {
+	if( !loadTables( 3 ) ) {
+		return EXIT_FAILURE;
+	}
+	if( strcmp( argv[1], "-coset-shard" ) == 0 ) {
+		if( argc < 7 ) {
+			return EXIT_FAILURE;
+		}
+		cosetSearch search( solver );
+		return search.runShard( atoi( argv[2] ), atoi( argv[3] ), atoll( argv[4] ), atoll( argv[5] ), argv[6] )
+			? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	int processes = argc > 2 ? atoi( argv[2] ) : std::thread::hardware_concurrency();
+	long long first = argc > 3 ? atoll( argv[3] ) : 0;
+	long long count = argc > 4 ? atoll( argv[4] ) : 100000;
+	const char * path = argc > 5 ? argv[5] : "cosets.bin";
+	if( processes < 1 ) {
+		processes = 1;
+	}
+	if( first < 0 || count < 1 || first + count > cosetSearch::NUM_COSETS ) {
+		std::cerr << "Cosets must be in 0 to " << cosetSearch::NUM_COSETS - 1 << std::endl;
+		return EXIT_FAILURE;
+	}
+	return cosetSearch::launch( argv[0], processes, first, count, path ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Times setting the face shader's per-frame uniforms by name against
+ * handles resolved once.  Needs a window for the GL context.
+ */
+int uniformBenchmark( int argc, char ** argv ) {
+	int count = argc > 2 ? atoi( argv[2] ) : 1000000;
+	glutInit( &argc, argv );
+	glutInitDisplayMode( GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH );
+	glutCreateWindow( " " );
+	glewInit();
+
+	Shader shader( "vfaceShader.glsl", "ffaceShader.glsl" );
+	shader.Bind();
+	Shader::Uniform palette = shader.GetUniformHandle( "palette[0]" );
+	Shader::Uniform sides = shader.GetUniformHandle( "sides[1]" );
+	Shader::Uniform pulse = shader.GetUniformHandle( "time" );
+	Shader::Uniform cursor = shader.GetUniformHandle( "cursor" );
+	mat4 m = RotateY( 30 );
+	vec4 v( 0.2, 0.2, 0.2, 1.0 );
+
+	double nanos[2];
+	for( int pass = 0; pass < 2; pass++ ) {
+		glFinish();
+		std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+		for( int i = 0; i < count; i++ ) {
+			if( pass == 0 ) {
+				shader.SetUniform( "palette[0]", v );
+				shader.SetUniform( "sides[1]", m );
+				shader.SetUniform( "time", 0.5f );
+				shader.SetUniform( "cursor", i & 7 );
+			}
+			else {
+				shader.SetUniform( palette, v );
+				shader.SetUniform( sides, m );
+				shader.SetUniform( pulse, 0.5f );
+				shader.SetUniform( cursor, i & 7 );
+			}
+		}
+		glFinish();
+		nanos[pass] = std::chrono::duration<double, std::nano>(
+			std::chrono::high_resolution_clock::now() - begin ).count() / ( 4.0 * count );
+	}
+	shader.Unbind();
+	printf( "SetUniform: %.1f ns per call by name, %.1f ns by handle (%d calls each)\n",
+		nanos[0], nanos[1], 4 * count );
+	return EXIT_SUCCESS;
+}
 
 int main( int argc, char **argv )
 {
+	/*Solver benchmark: rubiks -benchmark [count]*/
+	if( argc > 1 && strcmp( argv[1], "-benchmark" ) == 0 ) {
+		if( !solver.load( solverTables ) ) {
+			return EXIT_FAILURE;
+		}
+		solver.benchmark( argc > 2 ? atoi( argv[2] ) : 1000, 1 );
+		return EXIT_SUCCESS;
+	}
+
+	/*Optimal solver benchmark: rubiks -optimal [count] [scramble length] [threads]*/
+	if( argc > 1 && strcmp( argv[1], "-optimal" ) == 0 ) {
+		optimalSolver optimal;
+		if( !optimal.load( "optimal.tables" ) ) {
+			return EXIT_FAILURE;
+		}
+		optimal.setThreads( argc > 4 ? atoi( argv[4] ) : 0 );
+		optimal.benchmark( argc > 2 ? atoi( argv[2] ) : 10, argc > 3 ? atoi( argv[3] ) : 14, 1 );
+		return EXIT_SUCCESS;
+	}
+
+	/*Bidirectional search benchmark: rubiks -bidirectional [count] [scramble length]*/
+	if( argc > 1 && strcmp( argv[1], "-bidirectional" ) == 0 ) {
+		nearSolver.benchmark( argc > 2 ? atoi( argv[2] ) : 200, argc > 3 ? atoi( argv[3] ) : nearLength, 1 );
+		return EXIT_SUCCESS;
+	}
+
+	/*2x2 table benchmark: rubiks -pocket [count]*/
+	if( argc > 1 && strcmp( argv[1], "-pocket" ) == 0 ) {
+		if( !pocket.load( pocketTables ) ) {
+			return EXIT_FAILURE;
+		}
+		pocket.benchmark( argc > 2 ? atoi( argv[2] ) : 1000000, 1 );
+		return EXIT_SUCCESS;
+	}
+
+	/*Layer by layer hint benchmark: rubiks -layers [count]*/
+	if( argc > 1 && strcmp( argv[1], "-layers" ) == 0 ) {
+		layerSolver::benchmark( argc > 2 ? atoi( argv[2] ) : 10000, 1 );
+		return EXIT_SUCCESS;
+	}
+
+	/*Last layer cases: rubiks -lastlayer [count]*/
+	if( argc > 1 && strcmp( argv[1], "-lastlayer" ) == 0 ) {
+		if( !solver.load( solverTables ) ) {
+			return EXIT_FAILURE;
+		}
+		lastLayer cases;
+		cases.benchmark( solver, argc > 2 ? atoi( argv[2] ) : 100000, 1 );
+		return EXIT_SUCCESS;
+	}
+
+	/*Batch solver: rubiks -serve [socket path] [threads]*/
+	if( argc > 1 && strcmp( argv[1], "-serve" ) == 0 ) {
+		return serve( argc > 2 ? argv[2] : "-", argc > 3 ? atoi( argv[3] ) : 0 );
+	}
+
+	/*Random-state scrambles: rubiks -scramble [count] [dimensions] [seed] [threads]*/
+	if( argc > 1 && strcmp( argv[1], "-scramble" ) == 0 ) {
+		int dim = argc > 3 ? atoi( argv[3] ) : 3;
+		if( dim < 2 || !loadTables( dim ) ) {
+			return EXIT_FAILURE;
+		}
+		long count = argc > 2 ? atol( argv[2] ) : 1;
+		unsigned int seed = argc > 4 ? (unsigned int)strtoul( argv[4], NULL, 10 ) : (unsigned int)time( NULL );
+		return scrambles.generate( dim, count, seed, stdout, stderr, argc > 5 ? atoi( argv[5] ) : 0 ) == count
+			? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*Coset distances: rubiks -cosets [processes] [first] [count] [file]*/
+	if( argc > 1 && ( strcmp( argv[1], "-cosets" ) == 0 || strcmp( argv[1], "-coset-shard" ) == 0 ) ) {
+		return cosets( argc, argv );
+	}
+
+	/*Merge coset shard files: rubiks -coset-merge file shard files...*/
+	if( argc > 3 && strcmp( argv[1], "-coset-merge" ) == 0 ) {
+		return cosetSearch::merge( argv[2], argv + 3, argc - 3 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	/*Uniform upload benchmark: rubiks -uniforms [count]*/
+	if( argc > 1 && strcmp( argv[1], "-uniforms" ) == 0 ) {
+		return uniformBenchmark( argc, argv );
+	}
+
+	/*Reduction solver: rubiks -reduce dim [move file]*/
+	if( argc > 2 && strcmp( argv[1], "-reduce" ) == 0 ) {
+		return reduce( atoi( argv[2] ), argc > 3 ? argv[3] : NULL );
+	}
+
 	glutInit( &argc, argv );
 
 	glutInitDisplayMode( GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH );
@@ -205,12 +823,23 @@ int main( int argc, char **argv )
 	glewInit();
 
 	/*Where to input the dimensions of the cube*/
-	init( 3 );
+	int dimensions = argc > 1 ? atoi( argv[1] ) : 3;
+	init( dimensions > 0 ? dimensions : 3 );
+
+	/*Optional move file to replay*/
+	if( argc > 2 ) {
+		replayMoves( argv[2] );
+	}
+
+	scrambleSeed = (unsigned int)time( NULL );
+
+	//Tables are only built by solve jobs, so show their progress there
+	pruneTable::setProgress( tableProgress, &solving );
 
 	glutDisplayFunc(display);
 	glutKeyboardFunc(keyboard);
 	glutSpecialFunc(keyboardSpecial);
-	glutIdleFunc( idle );
+	wake();
 	glutMainLoop();
 	return 0;
 }
\ No newline at end of file
@@ -1,11 +1,36 @@
 #include "rubiksCube.h"
+#include "cubeValidator.h"
 
+//Milliseconds the cursor pulses after a change: three periods of the
+//pulse in ffaceShader.glsl, so it ends fully highlighted
+static const int pulseLength = 2000;
+
+//Smallest cube drawn from a sticker texture
+static const int lodDimensions = 32;
+
+//Rotation from the front face to a side
+static mat4 sideRotation( int side ) {
+	switch( side ) {
+		case 1:
+			return RotateY( 180 );
+		case 2:
+			return RotateX( -90 );
+		case 3:
+			return RotateX( 90 );
+		case 4:
+			return RotateY( 90 );
+		case 5:
+			return RotateY( -90 );
+	}
+	return Scale( 1.0 );
+}
 
 rubiksCube::rubiksCube( int dimensions ) {
 	//Initialize cursor
-	cursorHighlight = 0.2;
-	inc = 0.05;
 	cursor = 0;
+	changed = true;
+	pulseStart = 0;
+	pulse = 0;
 
 	//Set up color scheme
 	colors = (vec4 *)malloc( sizeof( vec4 ) * 6 );
@@ -19,23 +44,78 @@ rubiksCube::rubiksCube( int dimensions ) {
 	//Initialize animation data
 	anim = (Anim *)malloc( sizeof( Anim ) );
 	anim->rotate = false;
+	anim->axis = 0;
+	anim->first = 1;
+	anim->last = 0;
+	anim->quarters = 0;
 	anim->count = 0;
 	anim->numFrames = 15;
-	anim->transform = Scale( 1.0 );
+	anim->angle = 0.0;
 
 	dim = dimensions;
+	visible = 0;
 
 	isScrambled = false;
+	edits = 0;
+
+	//Cube state creation
+	state = new cubeModel( dimensions );
+	nextState = new cubeModel( dimensions );
+	hinted = (bool *)malloc( sizeof( bool ) * state->getNumStickers() );
+	for( int i = 0; i < state->getNumStickers(); i++ ) {
+		hinted[i] = false;
+	}
+	layer = (int *)malloc( sizeof( int ) * state->maxLayerStickers() );
+	flags = (unsigned char *)malloc( state->getNumStickers() );
+	for( int i = 0; i < state->getNumStickers(); i++ ) {
+		flags[i] = 0;
+	}
+	applied = false;
+	for( int side = 0; side < 6; side++ ) {
+		dirtyFirst[side] = dim * dim;
+		dirtyLast[side] = -1;
+	}
 
-	//Sides of cube creation
-	front = createSides( dimensions );
-	nextFront = createSides( dimensions );
+	//Large cubes draw each side from a texture, if it fits
+	GLint maxSize;
+	glGetIntegerv( GL_MAX_TEXTURE_SIZE, &maxSize );
+	lod = dim >= lodDimensions && 3 * dim <= maxSize;
+	stickerTexture = NULL;
+	lodShader = NULL;
+	if( lod ) {
+		baseCube = NULL;
+		baseShader = NULL;
+		numCubies = 0;
+		faceShader = NULL;
+		initLod();
+		return;
+	}
 
 	//VAO creation
 	Cube cube;
 	baseCube = new VertexArray();
 	baseCube->AddAttribute( "vPosition", cube.getVertices(), cube.getNumVertices() );
-	baseShader = new Shader( "vshader.glsl", "fshader.glsl" );
+
+	//Only the cubies on the surface are visible:
+	//6*(dim-2)^2 centers, 12*(dim-2) edges and 8 corners
+	int inner = dim > 2 ? dim - 2 : 0;
+	float * cubies = (float *)malloc( sizeof( float ) * 3 * ( dim * dim * dim - inner * inner * inner ) );
+	numCubies = 0;
+	for( int x = 0; x < dim; x++ ) {
+		for( int y = 0; y < dim; y++ ) {
+			for( int z = 0; z < dim; z++ ) {
+				if( x == 0 || y == 0 || z == 0 || x == dim - 1 || y == dim - 1 || z == dim - 1 ) {
+					cubies[3*numCubies] = (float)x;
+					cubies[3*numCubies + 1] = (float)y;
+					cubies[3*numCubies + 2] = (float)z;
+					numCubies++;
+				}
+			}
+		}
+	}
+	baseCube->AddInstanceAttribute( "vCubie", cubies, 3, numCubies );
+	free( cubies );
+	baseShader = new Shader( "vbaseShader.glsl", "fshader.glsl" );
 
 	face = new VertexArray();
 	vec4 facePoints[] = {
@@ -44,366 +124,282 @@ rubiksCube::rubiksCube( int dimensions ) {
 		vec3(  0.5,  0.5,  0.0),
 		vec3(  0.5, -0.5,  0.0) };
 	face->AddAttribute( "vPosition", facePoints, 4 );
+	face->AddInstanceAttribute( "vColor", state->getStickers(), 1, state->getNumStickers() );
+	face->AddInstanceAttribute( "vFlags", flags, 1, state->getNumStickers() );
 	faceShader = new Shader( "vfaceShader.glsl", "ffaceShader.glsl" );
-}
 
-rubiksCube::Side * rubiksCube::createSides( int dimensions ) {
-	Side * of_the_king;
-	//Front face setup
-	of_the_king = new Side( dimensions, colors[0] );
-	of_the_king->back = new Side( dimensions, colors[1] );
-	of_the_king->top = new Side( dimensions, colors[2] );
-	of_the_king->bottom = new Side( dimensions, colors[3] );
-	of_the_king->right = new Side( dimensions, colors[4] );
-	of_the_king->left = new Side( dimensions, colors[5] );
-	
-	//Back face setup
-	of_the_king->back->back = of_the_king;
-	of_the_king->back->top = of_the_king->bottom;
-	of_the_king->back->right = of_the_king->right;
-	of_the_king->back->left = of_the_king->left;
-	of_the_king->back->bottom = of_the_king->top;
-
-	//Top face setup
-	of_the_king->top->back = of_the_king->bottom;
-	of_the_king->top->top = of_the_king->back;
-	of_the_king->top->right = of_the_king->right;
-	of_the_king->top->left = of_the_king->left;
-	of_the_king->top->bottom = of_the_king;
-
-	//Bottom face setup
-	of_the_king->bottom->back = of_the_king->top;
-	of_the_king->bottom->top = of_the_king;
-	of_the_king->bottom->right = of_the_king->right;
-	of_the_king->bottom->left = of_the_king->left;
-	of_the_king->bottom->bottom = of_the_king->back;
-
-	//Right face setup
-	of_the_king->right->back = of_the_king->left;
-	of_the_king->right->top = of_the_king->top;
-	of_the_king->right->right = of_the_king->back;
-	of_the_king->right->left = of_the_king;
-	of_the_king->right->bottom = of_the_king->bottom;
-
-	//Left face setup
-	of_the_king->left->back = of_the_king->right;
-	of_the_king->left->top = of_the_king->bottom;
-	of_the_king->left->right = of_the_king->back;
-	of_the_king->left->left = of_the_king;
-	of_the_king->left->bottom = of_the_king->top;
-
-	return of_the_king;
+	//Uniforms that never change keep their values between frames
+	faceShader->Bind();
+	for( int side = 0; side < 6; side++ ) {
+		char name[16];
+		sprintf( name, "sides[%d]", side );
+		faceShader->SetUniform( name, sideRotation( side ) );
+	}
+	faceShader->SetUniform( "dim", dim );
+	for( int c = 0; c < 6; c++ ) {
+		char name[16];
+		sprintf( name, "palette[%d]", c );
+		faceShader->SetUniform( name, colors[c] );
+	}
+	faceShader->Unbind();
+	baseShader->Bind();
+	baseShader->SetUniform( "dim", dim );
+	baseShader->SetUniform( "color", vec4( 0.0, 0.0, 0.0, 1.0 ) );
+	baseShader->Unbind();
+
+	faceAxis = faceShader->GetUniformHandle( "axis" );
+	faceFirst = faceShader->GetUniformHandle( "first" );
+	faceLast = faceShader->GetUniformHandle( "last" );
+	faceAngle = faceShader->GetUniformHandle( "angle" );
+	faceVisible = faceShader->GetUniformHandle( "visible" );
+	faceCursor = faceShader->GetUniformHandle( "cursor" );
+	faceTime = faceShader->GetUniformHandle( "time" );
+	baseAxis = baseShader->GetUniformHandle( "axis" );
+	baseFirst = baseShader->GetUniformHandle( "first" );
+	baseLast = baseShader->GetUniformHandle( "last" );
+	baseAngle = baseShader->GetUniformHandle( "angle" );
+	baseVisible = baseShader->GetUniformHandle( "visible" );
 }
 
-rubiksCube::Side::Side( int dim, vec4 color ) {
-	numColors = dim * dim;
-	colors = (vec4 *)malloc( sizeof( vec4 ) * numColors );
-	rotate = (bool *)malloc( sizeof( bool ) * numColors );
-	for( int i = 0; i < numColors; i++ ) {
-		colors[i] = color;
-		rotate[i] = false;
+void rubiksCube::initLod() {
+	face = new VertexArray();
+	vec4 facePoints[] = {
+		vec3( -0.5, -0.5,  0.0),
+		vec3( -0.5,  0.5,  0.0),
+		vec3(  0.5,  0.5,  0.0),
+		vec3(  0.5, -0.5,  0.0) };
+	face->AddAttribute( "vPosition", facePoints, 4 );
+
+	//Filled by uploadDirty() before the first frame
+	stickerTexture = new Texture2D( (const GLubyte *)NULL, GL_RED, 3 * dim, 2 * dim,
+		GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE );
+	lodShader = new Shader( "vlodShader.glsl", "flodShader.glsl" );
+
+	lodShader->Bind();
+	for( int side = 0; side < 6; side++ ) {
+		char name[16];
+		sprintf( name, "sides[%d]", side );
+		lodShader->SetUniform( name, sideRotation( side ) );
 	}
-}
+	lodShader->SetUniform( "dim", dim );
+	for( int c = 0; c < 6; c++ ) {
+		char name[16];
+		sprintf( name, "palette[%d]", c );
+		lodShader->SetUniform( name, colors[c] );
+	}
+	lodShader->SetUniform( "stickers", 0 );
+	lodShader->Unbind();
 
-rubiksCube::~rubiksCube() {
-	delete front->back;
-	delete front->bottom;
-	delete front->top;
-	delete front->right;
-	delete front->left;
-	delete front;
-	free( colors );
-}
+	lodAxis = lodShader->GetUniformHandle( "axis" );
+	lodFirst = lodShader->GetUniformHandle( "first" );
+	lodLast = lodShader->GetUniformHandle( "last" );
+	lodAngle = lodShader->GetUniformHandle( "angle" );
+	lodCursor = lodShader->GetUniformHandle( "cursor" );
+	lodTime = lodShader->GetUniformHandle( "time" );
 
-//Side deletion only responsible for itself
-//Does not delete links to other sides
-rubiksCube::Side::~Side() {
-	free( colors );
+	markAllDirty();
 }
 
-void rubiksCube::displayCube( const mat4 & view, const mat4 & proj ) {
-	//Draw faces
-	drawFace( view, proj, 0, front, !anim->rotate );
-	drawFace( view, proj, 1, front->back, false );
-	drawFace( view, proj, 2, front->top, false );
-	drawFace( view, proj, 3, front->bottom, false );
-	drawFace( view, proj, 4, front->right, false );
-	drawFace( view, proj, 5, front->left, false );
+rubiksCube::~rubiksCube() {
+	delete state;
+	delete nextState;
+	free( hinted );
+	free( layer );
+	free( flags );
+	free( colors );
+	free( anim );
+	delete stickerTexture;
+	delete lodShader;
 }
 
-void rubiksCube::drawFace( mat4 view, mat4 proj, int rot, Side * side, bool drawCursor ) {
-	vec4 cur( cursorHighlight, cursorHighlight, cursorHighlight, 1.0 );
-	mat4 colorScale = Scale( 1 / (GLfloat)dim * 0.9 );	//Make faces slightly smaller than base cubes
-	mat4 cubeScale = Scale( 1 / (GLfloat)dim );	
-	vec4 v( view[2].x, view[2].y, view[2].z, 0.0 );	//Used for finding dot product of each face.
-	vec4 faceNorm( 0.0, 0.0, 1.0, 0.0 );	//Normal for the faces.
+void rubiksCube::displayCube( RenderQueue & queue, const vec3 & eye ) {
+	uploadDirty();
 
-	//Calculate rotation for drawing each side
-	mat4 rotation;
-	switch( rot ) {
-		case 1:
-			rotation = RotateY( 180 );
-			break;
-		case 2:
-			rotation = RotateX( -90 );
-			break;
-		case 3:
-			rotation = RotateX( 90 );
+	//Each change restarts the cursor pulse, which then holds at its end
+	int now = glutGet( GLUT_ELAPSED_TIME );
+	if( changed ) {
+		pulseStart = now;
+		changed = false;
+	}
+	pulse = now - pulseStart < pulseLength ? now - pulseStart : pulseLength;
+
+	//Cull whole sides: a side's outer plane (0.5 from the center, turned
+	//with its layers) is visible if the eye is in front of it
+	mat4 turn;
+	switch( anim->axis ) {
+		case 0:
+			turn = RotateX( anim->angle );
 			break;
-		case 4:
-			rotation = RotateY( 90 );
+		case 1:
+			turn = RotateY( anim->angle );
 			break;
-		case 5:
-			rotation = RotateY( -90 );
+		default:
+			turn = RotateZ( anim->angle );
 			break;
 	}
-
-	//Draw each block
-	for( int i = 0; i < dim; i++ ) {
-		for( int j = 0; j < dim; j++ ) {
-			mat4 rotModel = rotation;
-			if( anim->rotate ) {
-				//If block is involved in current animation
-				if( side->rotate[i*dim + j] ) { 
-					rotModel = anim->transform * rotation;
-				}
-			}
-
-			//Only draw block if facing towards camera.
-			//Becomes noticeable around 6x6 cubes during animations
-			if( dot( v, rotModel * faceNorm ) >= 0 ) {
-
-				//Draw colored face
-				mat4 model = Translate( (GLfloat)1/(2*dim) + 
-						(GLfloat)j/dim, -(GLfloat)1/(2*dim) - 
-						(GLfloat)i/dim, 0.0 ) * 
-					Translate( -0.5, 0.5, 0.51 ) * 
-					colorScale;
-				faceShader->Bind();
-				face->Bind( *faceShader );
-				faceShader->SetUniform( "color", side->colors[i*dim + j] );
-				faceShader->SetUniform( "model", rotModel * model );
-				faceShader->SetUniform( "cursor", (cursor == i*dim + j) && drawCursor);
-				faceShader->SetUniform( "highlight", cur );
-				faceShader->SetUniform( "view", view );
-				faceShader->SetUniform( "projection", proj );
-				face->Draw( GL_TRIANGLE_FAN );
-				face->Unbind();
-				faceShader->Unbind();
-
-				//Draw black base cube
-				model = Translate( (GLfloat)1/(2*dim) + 
-							(GLfloat)j/dim, -(GLfloat)1/(2*dim) - 
-							(GLfloat)i/dim, -(GLfloat)1/(2*dim) ) * 
-						Translate( -0.5, 0.5, 0.5 ) * 
-						cubeScale;
-				baseShader->Bind();
-				baseShader->SetUniform( "view", view );
-				baseShader->SetUniform( "model", rotModel * model );
-				baseShader->SetUniform( "projection", proj );
-				baseShader->SetUniform( "color", vec4( 0.0, 0.0, 0.0, 1.0 ) );
-				baseCube->Bind( *baseShader );
-				baseCube->Draw( GL_TRIANGLES );
-				baseCube->Unbind();
-				baseShader->Unbind();
-			}
+	vec4 v( eye.x, eye.y, eye.z, 0.0 );
+	visible = 0;
+	for( int side = 0; side < 6; side++ ) {
+		int x, y, z;
+		cubeModel::normal( side, x, y, z );
+		vec4 normal( (GLfloat)x, (GLfloat)y, (GLfloat)z, 0.0 );
+		if( dot( v, normal ) > 0.5 ) {
+			visible |= 1 << side;
+		}
+		if( anim->rotate && dot( v, turn * normal ) > 0.5 ) {
+			visible |= 1 << ( side + 6 );
 		}
 	}
-}
 
-void rubiksCube::rotate(bool v, bool d) {
-	if( anim->rotate ) { //already rotating
+	//Three blocks along the turn axis, six sides each
+	if( lod ) {
+		queue.Add( lodShader, face, GL_TRIANGLE_FAN, 18, stickerTexture, 0, setupLod, this );
 		return;
 	}
-	anim->rotate = true;
-	anim->vert = v;
-	anim->dir = d;
-	int column;
-	int row;
-	Side *tempFront = new Side(dim, vec4(0, 0, 0, 1));
-	for(int i = 0; i< dim*dim; i++){
-		tempFront->colors[i] = front->colors[i];
-	}
-	column = cursor % dim;
-	row = cursor / dim;
-	
-	//Vertical
-	if(v){
-		//rotate up
-		if(v && d){
-			for(int i = 0; i < dim; i++){
-				nextFront->colors[column + i*dim] = front->bottom->colors[column + i*dim];
-				nextFront->bottom->colors[column + i*dim] = front->back->colors[(dim*dim - 1) - (column + i*dim)];
-				nextFront->back->colors[(dim*dim - 1) - (column + i*dim)] = front->top->colors[column + i*dim];
-				nextFront->top->colors[column + i*dim] = tempFront->colors[column + i*dim];
-
-				front->rotate[column + i*dim] = true;
-				front->top->rotate[column + i*dim] = true;
-				front->back->rotate[(dim*dim - 1) - (column + i*dim)] = true;
-				front->bottom->rotate[column +i*dim] = true;
-			}
-
-			if(column == 0){
-				Side *tempLeft = new Side(dim, vec4(0, 0, 0, 1));
-				for(int i = 0; i< dim*dim; i++){
-					tempLeft->colors[i] = front->left->colors[i];
-				}
-				for( int i = 0; i < dim; i++ ) {
-					for( int j = 0; j < dim; j++ ) {
-						nextFront->left->colors[i*dim + j] = tempLeft->colors[dim - i - 1 + j * dim];
-						front->left->rotate[i*dim + j] = true;
-					}
-				}
-			}
-
-			if(column == (dim -1)){
-				Side *tempRight = new Side(dim, vec4(0, 0, 0, 1));
-				for(int i = 0; i< dim*dim; i++){
-					tempRight->colors[i] = front->right->colors[i];
-				}
-					
-				for( int i = 0; i < dim; i++ ) {
-					for( int j = 0; j < dim; j++ ) {
-						nextFront->right->colors[i*dim + j] = tempRight->colors[i + dim * dim - dim * (j + 1 )];		
-						front->right->rotate[i*dim + j] = true;
-					}
-				}
-			}
-		}
-	}
 
-	//rotate down
-	if(v && !d){
-		for(int i = 0; i < dim; i++){
-			nextFront->colors[column + i*dim] = front->top->colors[column + i*dim];
-			nextFront->top->colors[column + i*dim] = front->back->colors[(dim*dim - 1) - (column + i*dim)];
-			nextFront->back->colors[(dim*dim - 1) - (column + i*dim)] = front->bottom->colors[column + i*dim];
-			nextFront->bottom->colors[column + i*dim] = tempFront->colors[column + i*dim];
+	//Colored faces, then black cubies
+	queue.Add( faceShader, face, GL_TRIANGLE_FAN, state->getNumStickers(), NULL, 0, setupFaces, this );
+	queue.Add( baseShader, baseCube, GL_TRIANGLES, numCubies, NULL, 0, setupBase, this );
+}
 
-			front->rotate[column + i*dim] = true;
-			front->top->rotate[column + i*dim] = true;
-			front->back->rotate[(dim*dim - 1) - (column + i*dim)] = true;
-			front->bottom->rotate[column + i*dim] = true;	
-		}
+void rubiksCube::setupFaces( Shader & shader, void * data ) {
+	rubiksCube * cube = (rubiksCube *)data;
+	Anim * anim = cube->anim;
+	shader.SetUniform( cube->faceAxis, anim->axis );
+	shader.SetUniform( cube->faceFirst, anim->rotate ? anim->first : 1 );
+	shader.SetUniform( cube->faceLast, anim->rotate ? anim->last : 0 );
+	shader.SetUniform( cube->faceAngle, anim->angle );
+	shader.SetUniform( cube->faceCursor, anim->rotate ? -1 : cube->cursor );
+	shader.SetUniform( cube->faceVisible, cube->visible );
+	shader.SetUniform( cube->faceTime, cube->pulse / 1000.0f );
+}
 
-		if(column == 0){
-		Side *tempRight = new Side(dim, vec4(0, 0, 0, 1));
-			for(int i = 0; i< dim*dim; i++){
-				tempRight->colors[i] = front->left->colors[i];
-			}
-					
-			for( int i = 0; i < dim; i++ ) {
-				for( int j = 0; j < dim; j++ ) {
-					nextFront->left->colors[i*dim + j] = tempRight->colors[i + dim * dim - dim * (j + 1 )];		
-					front->left->rotate[i*dim + j] = true;
-				}
-			}
-		}
+void rubiksCube::setupBase( Shader & shader, void * data ) {
+	rubiksCube * cube = (rubiksCube *)data;
+	Anim * anim = cube->anim;
+	shader.SetUniform( cube->baseAxis, anim->axis );
+	shader.SetUniform( cube->baseFirst, anim->rotate ? anim->first : 1 );
+	shader.SetUniform( cube->baseLast, anim->rotate ? anim->last : 0 );
+	shader.SetUniform( cube->baseAngle, anim->angle );
+	shader.SetUniform( cube->baseVisible, cube->visible );
+}
 
-		if(column == (dim - 1)){
-			Side *tempRight = new Side(dim, vec4(0, 0, 0, 1));
-			for(int i = 0; i< dim*dim; i++){
-				tempRight->colors[i] = front->right->colors[i];
-			}
+void rubiksCube::setupLod( Shader & shader, void * data ) {
+	rubiksCube * cube = (rubiksCube *)data;
+	Anim * anim = cube->anim;
+	//Without a turn the middle block is the whole cube
+	shader.SetUniform( cube->lodAxis, anim->axis );
+	shader.SetUniform( cube->lodFirst, anim->rotate ? anim->first : 0 );
+	shader.SetUniform( cube->lodLast, anim->rotate ? anim->last : cube->dim - 1 );
+	shader.SetUniform( cube->lodAngle, anim->angle );
+	shader.SetUniform( cube->lodCursor, anim->rotate ? -1 : cube->cursor );
+	shader.SetUniform( cube->lodTime, cube->pulse / 1000.0f );
+}
 
-			for( int i = 0; i < dim; i++ ) {
-				for( int j = 0; j < dim; j++ ) {
-					nextFront->right->colors[i*dim + j] = tempRight->colors[dim - i - 1 + j * dim];
-					front->right->rotate[i*dim + j] = true;
-				}
-			}
-		}
+void rubiksCube::markDirty( int sticker ) {
+	int side = sticker / ( dim * dim );
+	int index = sticker % ( dim * dim );
+	if( index < dirtyFirst[side] ) {
+		dirtyFirst[side] = index;
 	}
-	
-	//Horizontal
-	if(!v) {
-		//rotate right
-		if(!v && d) {
-			for(int i = 0; i < dim; i++) {
-				nextFront->colors[row*dim + i] = front->left->colors[row*dim + i];
-				nextFront->left->colors[row*dim + i] = front->back->colors[row*dim + i];
-				nextFront->back->colors[row*dim + i] = front->right->colors[row*dim + i];
-				nextFront->right->colors[row*dim + i] = tempFront->colors[row*dim + i];
-
-				front->rotate[row*dim + i] = true;
-				front->left->rotate[row*dim + i] = true;
-				front->back->rotate[row*dim + i] = true;
-				front->right->rotate[row*dim + i] = true;	
-			}
-			
-			if(row == 0){
-				Side *tempTop = new Side(dim, vec4(0, 0, 0, 1));
-				for(int i = 0; i< dim*dim; i++){
-					tempTop->colors[i] = front->top->colors[i];
-				}
-
-				for( int i = 0; i < dim; i++ ) {
-					for( int j = 0; j < dim; j++ ) {
-						nextFront->top->colors[i*dim + j] = tempTop->colors[dim - i - 1 + j * dim];
-						
-						front->top->rotate[i*dim + j] = true;
-					}
-				}
-			}
+	if( index > dirtyLast[side] ) {
+		dirtyLast[side] = index;
+	}
+	changed = true;
+}
 
-			if(row == (dim - 1)){
-				Side *tempTop = new Side(dim, vec4(0, 0, 0, 1));
-				for(int i = 0; i< dim*dim; i++){
-					tempTop->colors[i] = front->bottom->colors[i];
-				}
+void rubiksCube::markAllDirty() {
+	for( int side = 0; side < 6; side++ ) {
+		dirtyFirst[side] = 0;
+		dirtyLast[side] = dim * dim - 1;
+	}
+	changed = true;
+}
 
-				for( int i = 0; i < dim; i++ ) {
-					for( int j = 0; j < dim; j++ ) {
-						nextFront->bottom->colors[i*dim + j] = tempTop->colors[i + dim * dim - dim * (j + 1 )];				
-						front->bottom->rotate[i*dim + j] = true;
-					}
-				}
-			}
+void rubiksCube::uploadDirty() {
+	const unsigned char * stickers = state->getStickers();
+	for( int side = 0; side < 6; side++ ) {
+		if( dirtyFirst[side] > dirtyLast[side] ) {
+			continue;
+		}
+		int first = side * dim * dim + dirtyFirst[side];
+		int length = dirtyLast[side] - dirtyFirst[side] + 1;
+		if( lod ) {
+			//Whole rows of the side's square in the texture.  Rows of dim
+			//bytes are not padded to 4, so the alignment is 1 meanwhile.
+			int row = dirtyFirst[side] / dim;
+			int rows = dirtyLast[side] / dim - row + 1;
+			GLint alignment;
+			glGetIntegerv( GL_UNPACK_ALIGNMENT, &alignment );
+			glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+			stickerTexture->Update( stickers + side * dim * dim + row * dim,
+				( side % 3 ) * dim, ( side / 3 ) * dim + row, dim, rows );
+			glPixelStorei( GL_UNPACK_ALIGNMENT, alignment );
+			dirtyFirst[side] = dim * dim;
+			dirtyLast[side] = -1;
+			continue;
 		}
+		for( int i = first; i < first + length; i++ ) {
+			flags[i] = hinted[i] ? 1 : 0;
+		}
+		face->UpdateAttribute( "vColor", stickers + first, first, length );
+		face->UpdateAttribute( "vFlags", flags + first, first, length );
+		dirtyFirst[side] = dim * dim;
+		dirtyLast[side] = -1;
+	}
+}
 
-		//rotate left
-		if(!v && !d){
-			for(int i = 0; i < dim; i++){
-				nextFront->colors[row*dim + i] = front->right->colors[row*dim + i];
-				nextFront->right->colors[row*dim + i] = front->back->colors[row*dim + i];
+void rubiksCube::rotate(bool v, bool d) {
+	if( anim->rotate ) { //already rotating
+		return;
+	}
+	int column = cursor % dim;
+	int row = cursor / dim;
+	markEdited();
 
-				nextFront->back->colors[row*dim + i] = front->left->colors[row*dim + i];
-				nextFront->left->colors[row*dim + i] = tempFront->colors[row*dim + i];
+	if( v ) {
+		//Columns turn about the x axis, up is -90 degrees
+		animateLayers( 0, column, column, d ? 3 : 1 );
+	}
+	else {
+		//Rows turn about the y axis, right is +90 degrees
+		animateLayers( 1, dim - 1 - row, dim - 1 - row, d ? 1 : 3 );
+	}
+}
 
-				front->rotate[row*dim + i] = true;
-				front->left->rotate[row*dim + i] = true;
-				front->back->rotate[row*dim + i] = true;
-				front->right->rotate[row*dim + i] = true;
-			}
+void rubiksCube::animateLayers( int axis, int first, int last, int quarters ) {
+	clearHint();
+	anim->rotate = true;
+	anim->axis = axis;
+	anim->quarters = quarters & 3;
+	anim->first = first;
+	anim->last = last;
+	nextState->turn( axis, first, last, quarters );
+}
 
-			if(row == 0){
-				Side *tempTop = new Side(dim, vec4(0, 0, 0, 1));
-				for(int i = 0; i< dim*dim; i++){
-					tempTop->colors[i] = front->top->colors[i];
-				}
+void rubiksCube::markEdited() {
+	//Queued moves were made for the cube before the edit
+	edits++;
+	queue.clear();
+}
 
-				for( int i = 0; i < dim; i++ ) {
-					for( int j = 0; j < dim; j++ ) {
-						nextFront->top->colors[i*dim + j] = tempTop->colors[i + dim * dim - dim * (j + 1 )];
-						front->top->rotate[i*dim + j] = true;
-					}
-				}
-			}
-			if(row == (dim - 1)){
-				Side *tempTop = new Side(dim, vec4(0, 0, 0, 1));
-				for(int i = 0; i< dim*dim; i++){
-					tempTop->colors[i] = front->bottom->colors[i];
-				}
-					
-				for( int i = 0; i < dim; i++ ) {
-					for( int j = 0; j < dim; j++ ) {
-						nextFront->bottom->colors[i*dim + j] = tempTop->colors[dim - i - 1 + j * dim];
-						front->bottom->rotate[i*dim + j] = true;
-					}
-				}
-			}
-		}
+void rubiksCube::applyMoves( const cubeModel::move * moves, int count ) {
+	nextState->apply( moves, count );
+	markEdited();
+	clearHint();
+	if( !anim->rotate ) {
+		*state = *nextState;
+		markAllDirty();
 	}
+	else {
+		//Shown when the animation ends
+		applied = true;
+	}
+	isScrambled = isScrambled || !nextState->isSolved();
+}
+
+void rubiksCube::queueMoves( const cubeModel::move * moves, int count ) {
+	queue.insert( queue.end(), moves, moves + count );
 }
 
 //Calls rotate on every row/column to acheive full cube rotation
@@ -411,7 +407,6 @@ void rubiksCube::rotateCube( bool v, bool d ) {
 	if(anim->rotate){
 		return;
 	}
-	Side * tempFront = front;
 	int tempCursor = cursor;
 	if( v ) {
 		if( d ) {
@@ -445,26 +440,15 @@ void rubiksCube::rotateCube( bool v, bool d ) {
 			}	
 		}
 	}
+	//Every layer turns
 	anim->rotate = true;
+	anim->first = 0;
+	anim->last = dim - 1;
 	cursor = tempCursor;
 }
 
-void rubiksCube::scramble() {
-	if(anim->rotate){
-		return;
-	}
-	
-	//Rotations based on current cursor rotation so save state and restore after
-	int tempCursor, vert, direction;
-	tempCursor = cursor;
-
-	//Simluated randomization.  Didn't use srand() because it kept generating
-	//seg faults.  This essentially achieves same results.
-	cursor = random % (dim*dim);
-	vert = random/3 % 2;
-	direction = random % 2;
-	rotate(vert, direction);
-	cursor = tempCursor;
+void rubiksCube::scramble( const cubeModel::move * moves, int count ) {
+	applyMoves( moves, count );
 	isScrambled = true;
 }
 
@@ -473,50 +457,9 @@ bool rubiksCube::isWin() {
 		return false;
 	}
 
-	//checks front face
-	for(int i = 1; i<dim*dim; i++){
-		if(nextFront->colors[i].x != nextFront->colors[i - 1].x
-			|| nextFront->colors[i].y != nextFront->colors[i - 1].y
-			|| nextFront->colors[i].z != nextFront->colors[i - 1].z
-			|| nextFront->colors[i].w != nextFront->colors[i - 1].w){
-				return false;
-		}
-	}
-	//checks right face
-	for(int i = 1; i<dim*dim; i++){
-		if(nextFront->right->colors[i].x != nextFront->right->colors[i - 1].x
-			|| nextFront->right->colors[i].y != nextFront->right->colors[i - 1].y
-			|| nextFront->right->colors[i].z != nextFront->right->colors[i - 1].z
-			|| nextFront->right->colors[i].w != nextFront->right->colors[i - 1].w){
-				return false;
-		}
-	}
-	//checks top face
-	for(int i = 1; i<dim*dim; i++){
-		if(nextFront->top->colors[i].x != nextFront->top->colors[i - 1].x
-			|| nextFront->top->colors[i].y != nextFront->top->colors[i - 1].y
-			|| nextFront->top->colors[i].z != nextFront->top->colors[i - 1].z
-			|| nextFront->top->colors[i].w != nextFront->top->colors[i - 1].w){
-				return false;
-		}
-	}
-	//checks left face
-	for(int i = 1; i<dim*dim; i++){
-		if(nextFront->left->colors[i].x != nextFront->left->colors[i - 1].x
-			|| nextFront->left->colors[i].y != nextFront->left->colors[i - 1].y
-			|| nextFront->left->colors[i].z != nextFront->left->colors[i - 1].z
-			|| nextFront->left->colors[i].w != nextFront->left->colors[i - 1].w){
-				return false;
-		}
-	}
-	//checks back face
-	for(int i = 1; i<dim*dim; i++){
-		if(nextFront->back->colors[i].x != nextFront->back->colors[i - 1].x
-			|| nextFront->back->colors[i].y != nextFront->back->colors[i - 1].y
-			|| nextFront->back->colors[i].z != nextFront->back->colors[i - 1].z
-			|| nextFront->back->colors[i].w != nextFront->back->colors[i - 1].w){
-				return false;
-		}
+	//checks every face
+	if( !nextState->isSolved() ) {
+		return false;
 	}
 	std::cout<<"Win!"<<std::endl;
 	return true;
@@ -525,6 +468,7 @@ bool rubiksCube::isWin() {
 bool rubiksCube::moveCursorRight() {
 	if( cursor % dim != dim - 1 ) {
 		cursor++;
+		changed = true;
 		return true;
 	}
 	return false;
@@ -533,6 +477,7 @@ bool rubiksCube::moveCursorRight() {
 bool rubiksCube::moveCursorLeft() {
 	if( cursor % dim != 0 ) {
 		cursor--;
+		changed = true;
 		return true;
 	}
 	return false;
@@ -541,6 +486,7 @@ bool rubiksCube::moveCursorLeft() {
 bool rubiksCube::moveCursorUp() {
 	if( cursor >= dim ) {
 		cursor -= dim;
+		changed = true;
 		return true;
 	}
 	return false;
@@ -549,11 +495,62 @@ bool rubiksCube::moveCursorUp() {
 bool rubiksCube::moveCursorDown() {
 	if( cursor + dim < dim * dim ) {
 		cursor += dim;
+		changed = true;
 		return true;
 	}
 	return false;
 }
 
+bool rubiksCube::loadState( const cubeModel & newState ) {
+	if( anim->rotate || newState.getDimensions() != dim ) {
+		return false;
+	}
+	cubeValidator::Result result = cubeValidator::validate( newState );
+	if( result != cubeValidator::VALID ) {
+		std::cerr << "Rejected cube state: " << cubeValidator::describe( result ) << std::endl;
+		return false;
+	}
+	*state = newState;
+	*nextState = newState;
+	markAllDirty();
+	markEdited();
+	clearHint();
+	isScrambled = !newState.isSolved();
+	return true;
+}
+
+void rubiksCube::getState( cubeModel & out ) {
+	out = *nextState;
+}
+
+bool rubiksCube::getHint( const lastLayer & cases, lastLayer::Hint & hint ) {
+	return cases.recognize( *nextState, hint );
+}
+
+void rubiksCube::showHint( cubeModel::move m ) {
+	clearHint();
+	int axis, first, last, quarters;
+	if( !nextState->resolve( m, axis, first, last, quarters ) ) {
+		return;
+	}
+	for( int l = first; l <= last; l++ ) {
+		int count = state->layerStickers( axis, l, layer );
+		for( int i = 0; i < count; i++ ) {
+			hinted[layer[i]] = true;
+			markDirty( layer[i] );
+		}
+	}
+}
+
+void rubiksCube::clearHint() {
+	for( int i = 0; i < state->getNumStickers(); i++ ) {
+		if( hinted[i] ) {
+			hinted[i] = false;
+			markDirty( i );
+		}
+	}
+}
+
 int rubiksCube::getDimensions() {
 	return dim;
 }
@@ -561,60 +558,42 @@ int rubiksCube::getCursor() {
 	return cursor;
 }
 
-void rubiksCube::update() {
-	//Update cursor
-	if( cursorHighlight >= 0.5 - inc || cursorHighlight <= 0.0 - inc) {
-		inc *= -1;
+bool rubiksCube::update() {
+	//Start the next queued move
+	if( !anim->rotate && !queue.empty() ) {
+		int axis, first, last, quarters;
+		if( nextState->resolve( queue.front(), axis, first, last, quarters ) ) {
+			animateLayers( axis, first, last, quarters );
+		}
+		queue.pop_front();
 	}
-	cursorHighlight += inc;
-
-	random = glutGet(GLUT_ELAPSED_TIME);
 
 	//Rest of method only relevant if rotating
 	if( !anim->rotate ) {
-		return;
-	}
-	if( anim->vert ) { //Vertical rotation
-		if( anim->dir ) { //Up
-			anim->transform = RotateX( (float)-90 / anim->numFrames ) * anim->transform;
-		}
-		else { //Down
-			anim->transform = RotateX( (float)90 / anim->numFrames ) * anim->transform;
-		}
-	}
-	else { //Horizontal rotation
-		if( anim->dir ) { //Right
-			anim->transform = RotateY( (float)90 / anim->numFrames ) * anim->transform;
-		}
-		else { //Left
-			anim->transform = RotateY( (float)-90 / anim->numFrames ) * anim->transform;
-		}
+		return changed || !queue.empty() || pulse < pulseLength;
 	}
+	//Quarter turns are counterclockwise, three of them are one clockwise turn
+	//The shaders rotate the turning layers, so only the angle changes
+	anim->angle += ( anim->quarters == 3 ? -90.0f : 90.0f * anim->quarters ) / anim->numFrames;
 	
 	anim->count++;
 	if( anim->count >= anim->numFrames ) {
-		Side * oldFront = front;
-		front = nextFront;
-		
-		delete oldFront->back;
-		delete oldFront->bottom;
-		delete oldFront->top;
-		delete oldFront->left;
-		delete oldFront->right;
-		delete oldFront;
-
-		nextFront = createSides( dim );
-		for( int i = 0; i < dim * dim; i++ ) {
-			nextFront->colors[i] = front->colors[i];
-			nextFront->back->colors[i] = front->back->colors[i];
-			nextFront->top->colors[i] = front->top->colors[i];
-			nextFront->bottom->colors[i] = front->bottom->colors[i];
-			nextFront->right->colors[i] = front->right->colors[i];
-			nextFront->left->colors[i] = front->left->colors[i];
+		//Only the turned stickers change, unless moves were applied meanwhile
+		*state = *nextState;
+		for( int l = anim->first; l <= anim->last; l++ ) {
+			int count = state->layerStickers( anim->axis, l, layer );
+			for( int i = 0; i < count; i++ ) {
+				markDirty( layer[i] );
+			}
+		}
+		if( applied ) {
+			markAllDirty();
+			applied = false;
 		}
 
 		anim->count = 0;
 		anim->rotate = false;
-		anim->transform = Scale( 1.0 );
+		anim->angle = 0.0;
 	}
+	return true;
 }
@@ -2,38 +2,21 @@
 #ifndef RUBIKSCUBE_H
 #define RUBIKSCUBE_H
 #include "Angel.h"
+#include "RenderQueue.h"
 #include "Shader.h"
+#include "Texture2D.h"
 #include "VertexArray.h"
 #include "cube.h"
+#include "cubeModel.h"
+#include "lastLayer.h"
+#include <deque>
 
 class rubiksCube{
 private:
-	/*
-	 * Class to maintain cube state.
-	 */
-	class Side {
-		public:
-			/*
-			 * Constructor
-			 */
-			Side( int dim, vec4 color );
-
-			/*
-			 * Destructor
-			 */
-			~Side();
-
-			vec4 * colors; //Array of colors on the side
-			bool * rotate; //Rotate face?
-			int numColors; //Number of faces per side
-			Side * back;
-			Side * right;
-			Side * left;
-			Side * top;
-			Side * bottom;
-	};
-	Side * front;	//Currently displayed face
-	Side * nextFront; //Face to display after animations
+	cubeModel * state;		//Currently displayed stickers
+	cubeModel * nextState;	//Stickers to display after animations
+	bool * hinted;			//Sticker is in the layer of the hinted move?
+	int * layer;			//Scratch space for cubeModel::layerStickers
 
 	/* Colors:
 	 * 0: Front - Green
@@ -45,44 +28,111 @@ private:
 	 */
 	vec4 * colors;
 
+
+	//Stickers are drawn as instances whose colors (palette indices) and
+	//flags stay in GPU buffers.  Changed stickers are marked dirty and
+	//only their range on each side is uploaded before the next frame.
+	unsigned char * flags;	//Sticker flags for the face shader: 1 hinted
+	int dirtyFirst[6];		//Changed stickers of each side since the last upload,
+	int dirtyLast[6];		//none if dirtyFirst > dirtyLast
+	bool applied;			//Moves applied to nextState while animating?
+
 	/*
 	 * Contains information for animations
 	 */
 	typedef struct _anim {
 		bool rotate;	//Cube is rotating?
-		bool vert;		//Vertical = true;  Horizontal = false;
-		bool dir;		//Right and Up = true;  Left and Down = false;
-		int section;	//Which column/row
+		int axis;		//Axis of the turn, 0 = x, 1 = y, 2 = z
+		int first;		//Turning layers, cell coordinates along axis
+		int last;
+		float angle;	//Angle of the turn so far in degrees, counterclockwise
+		int quarters;	//Quarter turns counterclockwise about the axis
 		int count;		//Current frame in animation
 		int numFrames;	//Number of frames for animation
-		mat4 transform;
 	} Anim;
 	Anim * anim;	//Stores animation data
+	std::deque<cubeModel::move> queue;	//Moves waiting to be animated
 
-	VertexArray * baseCube;	//VAO for black cube behind colored face
+	VertexArray * baseCube;	//VAO for black cubies, one instance per cubie on the surface
 	Shader * baseShader;	//Shader for baseCube
-	VertexArray * face;		//Colored face for each individual block
+	int numCubies;			//Instances of baseCube
+	VertexArray * face;		//Colored face, one instance per sticker
 	Shader * faceShader;	//Shader for face
 
+	//Cubes of lodDimensions and up have stickers a few pixels wide, so
+	//each side is one quad reading its colors from a texture instead.
+	//A turn splits the cube into the turning block and the blocks on
+	//either side, each drawn as a box, so the cost does not grow with dim.
+	bool lod;					//Drawing sides from stickerTexture?
+	Texture2D * stickerTexture;	//Palette index of each sticker, sides in 3 columns and 2 rows
+	Shader * lodShader;			//Draws face once per side of each block
+	Shader::Uniform lodAxis, lodFirst, lodLast, lodAngle, lodCursor, lodTime;
+
+	//Uniforms set every frame, resolved once by the constructor
+	Shader::Uniform faceAxis, faceFirst, faceLast, faceAngle, faceCursor, faceTime, faceVisible;
+	Shader::Uniform baseAxis, baseFirst, baseLast, baseAngle, baseVisible;
+
+	/*
+	 * Sides facing the camera this frame: bit side for the side, bit
+	 * 6 + side for its part in the turning layers.  The shaders skip
+	 * stickers and cubies on hidden sides, so only these twelve normals
+	 * are tested instead of every sticker.
+	 */
+	int visible;
+
 	int cursor;		//Position of cursor on front face
 	int dim;		//Dimensions of cube
-	unsigned int random;	//Random value used for scramble()
 
 	bool isScrambled;	//Has cube been scrambled?
+	int edits;			//Changes not made by queued moves, see getEdits()
 
-	float cursorHighlight;	//Highlight amount of cursor
-	float inc;	//Incremental change used for cursor highlighting
+	//The cursor pulses for a moment after each change, driven by the
+	//face shader from the time since the pulse started.  Frames are
+	//only needed while the cube changes, turns or pulses.
+	bool changed;		//Cube looks different since the last frame?
+	int pulseStart;		//Time the cursor pulse started in milliseconds
+	int pulse;			//Milliseconds of the pulse shown by the last frame
 
-	/* 
-	 * Helper method for displayCube.  Draws one side of the cube. 
+	/*
+	 * Render queue setup functions: set the per-frame uniforms of the
+	 * face and base shaders.  data is the cube.  Turning layers are
+	 * rotated by the shaders from the axis, layers and angle of the turn.
+	 */
+	static void setupFaces( Shader & shader, void * data );
+	static void setupBase( Shader & shader, void * data );
+	static void setupLod( Shader & shader, void * data );
+
+	/*
+	 * Helper method for the constructor.  Creates the side quad, sticker
+	 * texture and shader of the texture renderer.
 	 */
-	void drawFace( mat4 view, mat4 proj, int rot, Side * side, bool drawCursor );
+	void initLod();
+
+	/*
+	 * Marks a sticker (or all of them) to be uploaded before the next
+	 * frame, which also restarts the cursor pulse.  Must be called
+	 * whenever state or hinted change.
+	 */
+	void markDirty( int sticker );
+	void markAllDirty();
 
 	/* 
-	 * Helper method for constructor.  Generates one side for cube.
-	 * Does not handle linkage between sides.
+	 * Helper method for displayCube.  Uploads the colors and flags of the
+	 * dirty stickers.
+	 */
+	void uploadDirty();
+
+	/*
+	 * Counts a change not made by queued moves and drops the moves still
+	 * queued, which would otherwise play on the changed cube.
 	 */
-	Side * createSides( int dimensions );
+	void markEdited();
+
+	/*
+	 * Starts animating a turn of layers first..last and applies it to
+	 * nextState.  Arguments are the same as cubeModel::turn.
+	 */
+	void animateLayers( int axis, int first, int last, int quarters );
 
 public:
 
@@ -104,9 +154,16 @@ public:
 	~rubiksCube();	
 
 	/*
-	 * Displays the Rubik's cube.  Should be called in the Display() function
+	 * Adds the Rubik's cube to a frame's render queue.  Should be called in
+	 * the Display() function with the camera's position; the queue
+	 * must be submitted after the shared Camera block (see Shader) is
+	 * updated.
+	 * All stickers are drawn with one instanced draw call and the black
+	 * surface cubies, each once, with a second one.  Stickers and cubies
+	 * facing away are dropped by the vertex shaders.  Large cubes are one
+	 * draw of at most 18 textured quads instead.
 	 */
-	void displayCube( const mat4 & view, const mat4 & proj );
+	void displayCube( RenderQueue & queue, const vec3 & eye );
 
 	/*
 	 * Rotates a row up/down or a column right/left from cursor position.
@@ -115,6 +172,31 @@ public:
 	 */
 	void rotate(bool v, bool d);
 
+	/*
+	 * Applies a batch of packed moves (see cubeModel::move) immediately,
+	 * without animation.  Used to replay move files at parser speed.
+	 */
+	void applyMoves( const cubeModel::move * moves, int count );
+
+	/*
+	 * Adds packed moves to the end of the animation queue.  One move is
+	 * animated after the other by update().
+	 */
+	void queueMoves( const cubeModel::move * moves, int count );
+
+	/*
+	 * Returns whether a turn is animating or queued.
+	 */
+	bool isMoving() const { return anim->rotate || !queue.empty(); }
+
+	/*
+	 * Number of changes made to the cube other than by queued moves:
+	 * turns, rotations and loaded states.  A solution found for the cube
+	 * is only valid while this stays the same; each edit also drops the
+	 * moves still queued.
+	 */
+	int getEdits() const { return edits; }
+
 	/*
 	 * Rotates entier cube along X or Y axis
 	 * v = true: rotate vertically;  v = false: rotate horizontally
@@ -123,9 +205,10 @@ public:
 	void rotateCube( bool v, bool d );
 
 	/*
-	 * Randomly rotates a row and column.
+	 * Applies a scramble at once, without animation, and marks the cube
+	 * as scrambled.  See scrambler.
 	 */
-	void scramble();
+	void scramble( const cubeModel::move * moves, int count );
 
 	/*
 	 * Returns whether cube is solved.  Must be scrambled first.
@@ -133,10 +216,12 @@ public:
 	bool isWin();
 
 	/*
-	 * Updates cursor and animations for each frame.
-	 * Called for each frame.
+	 * Advances animations by one frame.  Returns whether the cube needs
+	 * to be redrawn: it is turning or has moves queued, it changed since
+	 * the last frame or its cursor is still pulsing.  Once it returns
+	 * false the frame timer can stop until the next change.
 	 */
-	void update();
+	bool update();
 
 	/*
 	 * Moves cursor one place to right on front face.  
@@ -166,6 +251,37 @@ public:
 	 */
 	bool moveCursorDown();
 
+	/*
+	 * Replaces the cube's colors with a sticker state.  The state is
+	 * checked with cubeValidator first and rejected if it can not be
+	 * reached from a solved cube.  Returns true if the state was loaded.
+	 */
+	bool loadState( const cubeModel & state );
+
+	/*
+	 * Copies the cube's colors (after any running animation) into a
+	 * sticker state of the same dimensions.
+	 */
+	void getState( cubeModel & state );
+
+	/*
+	 * Recognizes the last layer case of a 3x3 (after any running
+	 * animation) and fills in the hint for its next step.  Returns false
+	 * if the cube is not at the last layer.
+	 */
+	bool getHint( const lastLayer & cases, lastLayer::Hint & hint );
+
+	/*
+	 * Highlights the layers a move turns, like the cursor, until the
+	 * cube next changes.
+	 */
+	void showHint( cubeModel::move m );
+
+	/*
+	 * Removes the hint highlight.
+	 */
+	void clearHint();
+
 	/*
 	 * Returns number of blocks in a row/column.
 	 */
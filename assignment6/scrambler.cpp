@@ -0,0 +1,114 @@
+#include "scrambler.h"
+#include "moveParser.h"
+#include "workPool.h"
+#include <chrono>
+
+//Spreads consecutive seeds over the generator's states
+static unsigned int mixSeed( unsigned int seed ) {
+	seed ^= seed >> 16;
+	seed *= 0x7FEB352Du;
+	seed ^= seed >> 15;
+	seed *= 0x846CA68Bu;
+	seed ^= seed >> 16;
+	return seed;
+}
+
+static unsigned int nextRandom( unsigned int & seed ) {
+	if( seed == 0 ) {
+		seed = 0x9E3779B9u;
+	}
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+//Writes the inverse of a cubieCube move sequence as packed moves
+static void invert( const unsigned char * moves, int length, std::vector<cubeModel::move> & out ) {
+	out.resize( length );
+	for( int i = 0; i < length; i++ ) {
+		int m = moves[length - 1 - i];
+		out[i] = cubieCube::toMove( cubieCube::moveFace( m ) * 3 + 2 - m % 3 );
+	}
+}
+
+scrambler::scrambler( const kociembaSolver & solver, const pocketSolver & pocket, int maxLength )
+	: solver( solver ), pocket( pocket ), maxLength( maxLength ) {
+}
+
+bool scrambler::scramble( int dim, unsigned int seed, std::vector<cubeModel::move> & out ) const {
+	seed = mixSeed( seed );
+	unsigned char moves[64];
+	if( dim == 2 ) {
+		unsigned long long r = (unsigned long long)nextRandom( seed ) << 32 | nextRandom( seed );
+		int length = pocket.solve( (int)( r % pocketSolver::NUM_STATES ), moves );
+		if( length < 0 ) {
+			return false;
+		}
+		invert( moves, length, out );
+		return true;
+	}
+	if( dim == 3 ) {
+		cubieCube cube;
+		cube.randomize( seed );
+		int length = solver.solve( cube, moves, maxLength );
+		if( length < 0 ) {
+			return false;
+		}
+		invert( moves, length, out );
+		return true;
+	}
+	//Reduction solutions are far too long to invert, see scrambler.h
+	out.resize( dim * 20 );
+	for( int i = 0; i < dim * 20; i++ ) {
+		int layer = nextRandom( seed ) % dim;
+		out[i] = cubeModel::makeMove( nextRandom( seed ) % 6, 1 + nextRandom( seed ) % 3, layer, layer );
+	}
+	return true;
+}
+
+long scrambler::generate( int dim, long count, unsigned int seed, FILE * out, FILE * log, int threads ) const {
+	workPool pool( threads );
+	std::vector<std::vector<cubeModel::move> > scrambles( BATCH );
+	std::vector<char> ok( BATCH );
+	std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+	long written = 0, failed = 0;
+	long long totalLength = 0;
+	char text[32];
+	for( long first = 0; first < count; first += BATCH ) {
+		int size = count - first < BATCH ? (int)( count - first ) : (int)BATCH;
+		pool.run( ( size + CHUNK - 1 ) / CHUNK, [&]( int worker, int task ) {
+			int end = ( task + 1 ) * CHUNK < size ? ( task + 1 ) * CHUNK : size;
+			for( int i = task * CHUNK; i < end; i++ ) {
+				ok[i] = scramble( dim, seed + (unsigned int)( first + i ), scrambles[i] );
+			}
+		} );
+
+		//Written in seed order
+		for( int i = 0; i < size; i++ ) {
+			if( !ok[i] ) {
+				failed++;
+				continue;
+			}
+			const std::vector<cubeModel::move> & moves = scrambles[i];
+			for( size_t k = 0; k < moves.size(); k++ ) {
+				moveParser::format( moves[k], text );
+				fprintf( out, k + 1 < moves.size() ? "%s " : "%s", text );
+			}
+			fputc( '\n', out );
+			totalLength += moves.size();
+			written++;
+		}
+		fflush( out );
+	}
+
+	double seconds = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - begin ).count();
+	fprintf( log, "%ld %dx%d scrambles in %.2f s on %d threads, %.0f scrambles/s, average %.2f moves",
+		written, dim, dim, seconds, pool.getThreads(), count / ( seconds > 0 ? seconds : 1 ),
+		written ? (double)totalLength / written : 0.0 );
+	if( failed ) {
+		fprintf( log, ", %ld not solved", failed );
+	}
+	fprintf( log, "\n" );
+	return written;
+}
@@ -0,0 +1,61 @@
+//Header file for Rubiks cube project
+#ifndef SCRAMBLER_H
+#define SCRAMBLER_H
+#include "kociemba.h"
+#include "pocket.h"
+#include <cstdio>
+#include <vector>
+
+/*
+ * Random-state scrambles: a uniformly random solvable state is drawn and
+ * solved, and the scramble is the inverse of the solution, so every state
+ * is equally likely however the solver picks its moves.
+ *
+ * 3x3 states are solved with the two-phase solver and 2x2 states from the
+ * complete distance table (the shortest scramble for the state).  4x4
+ * and up get dim * 20 random layer turns instead: the reduction solver
+ * is fast enough, but its solutions are 5 (4x4) to 75 (40x40) times
+ * longer than that, which is no use for a scramble anyone will replay.
+ *
+ * A scramble only depends on its seed, so bulk sets come out the same
+ * whatever the number of threads.
+ */
+class scrambler {
+public:
+	/*
+	 * Constructor.  The tables of the dimensions used must be loaded:
+	 * the two-phase tables for 3x3, the 2x2 table for 2x2.  3x3
+	 * scrambles are at most maxLength moves; 22 finds them fastest.
+	 */
+	scrambler( const kociembaSolver & solver, const pocketSolver & pocket, int maxLength = 22 );
+
+	/*
+	 * Writes the scramble for seed to out.  Returns false if the state
+	 * could not be solved within maxLength moves, which does not happen
+	 * for maxLength 20 and up.
+	 */
+	bool scramble( int dim, unsigned int seed, std::vector<cubeModel::move> & out ) const;
+
+	/*
+	 * Writes count scrambles, one per line, for seeds seed, seed + 1, ...
+	 * to out.  They are made on threads threads (0 = one per hardware
+	 * thread) and written in order.  Throughput and the average length
+	 * are written to log.  Returns the number of scrambles written.
+	 */
+	long generate( int dim, long count, unsigned int seed, FILE * out, FILE * log, int threads = 0 ) const;
+
+	enum {
+		CHUNK = 64,		//Scrambles per task
+		BATCH = 16384	//Scrambles written at once
+	};
+
+private:
+	const kociembaSolver & solver;
+	const pocketSolver & pocket;
+	int maxLength;
+
+	//Not copyable
+	scrambler( const scrambler & );
+	scrambler & operator=( const scrambler & );
+};
+#endif
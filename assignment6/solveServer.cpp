@@ -0,0 +1,196 @@
+#include "solveServer.h"
+#include "bidirectional.h"
+#include "workPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <chrono>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+//high_resolution_clock is only system_clock on VS2012, far too coarse for single solves
+#ifdef _WIN32
+static long long ticksNow() {
+	LARGE_INTEGER now;
+	QueryPerformanceCounter( &now );
+	return now.QuadPart;
+}
+
+static double millisSince( long long begin ) {
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency( &frequency );
+	return ( ticksNow() - begin ) * 1000.0 / frequency.QuadPart;
+}
+#else
+static long long ticksNow() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+static double millisSince( long long begin ) {
+	return ( ticksNow() - begin ) / 1e6;
+}
+#endif
+
+solveServer::solveServer( const kociembaSolver & solver, int threads, int maxLength )
+	: solver( solver ), maxLength( maxLength ), histogram( NUM_BUCKETS, 0 ) {
+	pool = new workPool( threads );
+	log = stderr;
+	totalStates = 0;
+	totalBatches = 0;
+	busyMillis = 0;
+}
+
+solveServer::~solveServer() {
+	delete pool;
+}
+
+long solveServer::serve( FILE * in, FILE * out ) {
+	long solved = 0;
+	unsigned int count;
+	while( fread( &count, sizeof( count ), 1, in ) == 1 ) {
+		if( count > MAX_BATCH ) {
+			fprintf( log, "Batch of %u states is over the limit of %d\n", count, (int)MAX_BATCH );
+			return -1;
+		}
+		states.resize( count * 2 );
+		if( count && fread( &states[0], sizeof( unsigned long long ) * 2, count, in ) != count ) {
+			fprintf( log, "Stream ended inside a batch\n" );
+			return -1;
+		}
+
+		long long begin = ticksNow();
+		solveBatch( (int)count );
+
+		//Reply in request order
+		for( unsigned int i = 0; i < count; i++ ) {
+			fputc( lengths[i], out );
+			if( lengths[i] != UNSOLVED ) {
+				fwrite( &moves[i * maxLength], 1, lengths[i], out );
+			}
+		}
+		fflush( out );
+		double millis = millisSince( begin );
+
+		//Batch statistics
+		busyMillis += millis;
+		totalStates += count;
+		totalBatches++;
+		solved += count;
+		if( count ) {
+			std::vector<float> sorted( latency.begin(), latency.begin() + count );
+			std::sort( sorted.begin(), sorted.end() );
+			fprintf( log, "Batch %lld: %u states in %.1f ms, %.0f states/s, latency us p50 %.0f p90 %.0f p99 %.0f max %.0f\n",
+				totalBatches, count, millis, count * 1000.0 / ( millis > 0 ? millis : 1 ),
+				sorted[count / 2], sorted[count * 9 / 10], sorted[count * 99 / 100], sorted[count - 1] );
+		}
+	}
+	printStats();
+	return solved;
+}
+
+void solveServer::solveBatch( int count ) {
+	lengths.resize( count );
+	moves.resize( (size_t)count * maxLength );
+	latency.resize( count );
+	int chunks = ( count + CHUNK - 1 ) / CHUNK;
+	pool->run( chunks, [&]( int worker, int task ) {
+		int end = std::min( count, ( task + 1 ) * CHUNK );
+		for( int i = task * CHUNK; i < end; i++ ) {
+			long long begin = ticksNow();
+			bidirectionalSolver::packedState packed = { states[i * 2], states[i * 2 + 1] };
+			cubieCube cube;
+			int length = -1;
+			if( bidirectionalSolver::unpack( packed, cube ) ) {
+				length = solver.solve( cube, &moves[(size_t)i * maxLength], maxLength );
+			}
+			lengths[i] = length < 0 ? (unsigned char)UNSOLVED : (unsigned char)length;
+			latency[i] = (float)( millisSince( begin ) * 1000 );
+		}
+	} );
+
+	//Histogram is only touched here, after the workers are done
+	for( int i = 0; i < count; i++ ) {
+		int bucket = (int)( log2( 1.0 + latency[i] ) * BUCKET_STEPS );
+		histogram[bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1]++;
+	}
+}
+
+double solveServer::percentile( double fraction ) const {
+	long long target = (long long)( totalStates * fraction );
+	long long seen = 0;
+	for( int b = 0; b < NUM_BUCKETS; b++ ) {
+		seen += histogram[b];
+		if( seen > target ) {
+			return pow( 2.0, ( b + 1.0 ) / BUCKET_STEPS ) - 1;
+		}
+	}
+	return pow( 2.0, (double)NUM_BUCKETS / BUCKET_STEPS ) - 1;
+}
+
+void solveServer::printStats() {
+	if( !totalStates ) {
+		return;
+	}
+	fprintf( log, "Total: %lld states in %lld batches, %.0f states/s (%d threads), latency us p50 %.0f p90 %.0f p99 %.0f p99.9 %.0f\n",
+		totalStates, totalBatches, totalStates * 1000.0 / ( busyMillis > 0 ? busyMillis : 1 ), pool->getThreads(),
+		percentile( 0.5 ), percentile( 0.9 ), percentile( 0.99 ), percentile( 0.999 ) );
+	fflush( log );
+}
+
+#ifdef _WIN32
+bool solveServer::listen( const char * path ) {
+	fprintf( log, "UNIX domain sockets are not supported here, serve stdin instead\n" );
+	return false;
+}
+#else
+bool solveServer::listen( const char * path ) {
+	int server = socket( AF_UNIX, SOCK_STREAM, 0 );
+	sockaddr_un address;
+	memset( &address, 0, sizeof( address ) );
+	address.sun_family = AF_UNIX;
+	if( server < 0 || strlen( path ) >= sizeof( address.sun_path ) ) {
+		fprintf( log, "Could not create socket %s\n", path );
+		return false;
+	}
+	strcpy( address.sun_path, path );
+	unlink( path );
+	if( bind( server, (sockaddr *)&address, sizeof( address ) ) < 0 || ::listen( server, 4 ) < 0 ) {
+		fprintf( log, "Could not listen on %s\n", path );
+		close( server );
+		return false;
+	}
+	fprintf( log, "Listening on %s\n", path );
+	fflush( log );
+
+	//A client leaving early must not end the server
+	signal( SIGPIPE, SIG_IGN );
+
+	//One client at a time; the tables stay loaded between them
+	for( ;; ) {
+		int client = accept( server, NULL, NULL );
+		if( client < 0 ) {
+			continue;
+		}
+		FILE * in = fdopen( client, "rb" );
+		FILE * out = in ? fdopen( dup( client ), "wb" ) : NULL;
+		if( out ) {
+			serve( in, out );
+			fclose( out );
+		}
+		if( in ) {
+			fclose( in );
+		}
+		else {
+			close( client );
+		}
+	}
+}
+#endif
@@ -0,0 +1,109 @@
+//Header file for Rubiks cube project
+#ifndef SOLVESERVER_H
+#define SOLVESERVER_H
+#include "kociemba.h"
+#include <cstdio>
+#include <vector>
+
+class workPool;
+
+/*
+ * Batch solver for 3x3 states that stays running, so the two-phase
+ * tables are loaded once and stay in memory for every request.
+ *
+ * Requests and replies are binary, in the byte order of the host:
+ *	- request: a 32-bit state count, then that many packed states, each
+ *	  two 64-bit words as written by bidirectionalSolver::pack()
+ *	- reply: for each state in order, an 8-bit move count (255 if the
+ *	  state is not solvable) followed by that many cubieCube move numbers
+ * Each batch is split into chunks that are solved on all cores, and its
+ * reply is written and flushed as soon as the batch is done.
+ *
+ * Per batch and at the end of each stream, the throughput and the
+ * latency percentiles of single solves are written to the log.
+ */
+class solveServer {
+public:
+	/*
+	 * Constructor.  The solver must be loaded.  threads = 0 uses one per
+	 * hardware thread.  Solutions are at most maxLength moves; 22 gives
+	 * the fastest two-phase solves on average.
+	 */
+	solveServer( const kociembaSolver & solver, int threads = 0, int maxLength = 22 );
+
+	/*
+	 * Destructor
+	 */
+	~solveServer();
+
+	/*
+	 * Serves requests from in until it ends.  Returns the number of
+	 * states solved, or -1 if the stream ended inside a request or a
+	 * request was too large.
+	 */
+	long serve( FILE * in, FILE * out );
+
+	/*
+	 * Listens on a UNIX domain socket at path and serves one connection
+	 * after the other.  Returns false if the socket could not be created
+	 * (or sockets are not supported, as on Windows).  Otherwise it does
+	 * not return.
+	 */
+	bool listen( const char * path );
+
+	/*
+	 * Where statistics are written, stderr by default.
+	 */
+	void setLog( FILE * log ) { this->log = log; }
+
+	/*
+	 * Writes totals since the server started: states, throughput and
+	 * single solve latency percentiles.
+	 */
+	void printStats();
+
+	enum {
+		MAX_BATCH = 1 << 20,	//Most states in one request
+		CHUNK = 64,				//States per task
+		UNSOLVED = 255			//Reply length of an unsolvable state
+	};
+
+private:
+	const kociembaSolver & solver;
+	workPool * pool;
+	int maxLength;
+	FILE * log;
+
+	//Buffers for the current batch
+	std::vector<unsigned long long> states;
+	std::vector<unsigned char> lengths;
+	std::vector<unsigned char> moves;	//maxLength per state
+	std::vector<float> latency;			//Microseconds per state
+
+	/*
+	 * Latency histogram of every solve so far.  Buckets are spaced
+	 * logarithmically, BUCKET_STEPS per doubling of the microseconds, so
+	 * percentiles are within 10% from a microsecond to over an hour.
+	 */
+	enum { BUCKET_STEPS = 8, NUM_BUCKETS = 32 * BUCKET_STEPS };
+	std::vector<long long> histogram;
+	long long totalStates;
+	long long totalBatches;
+	double busyMillis;	//Time spent solving batches
+
+	/*
+	 * Solves states[0..count) into lengths and moves.
+	 */
+	void solveBatch( int count );
+
+	/*
+	 * Latency below which the given fraction of solves fall, from the
+	 * histogram, in microseconds.
+	 */
+	double percentile( double fraction ) const;
+
+	//Not copyable
+	solveServer( const solveServer & );
+	solveServer & operator=( const solveServer & );
+};
+#endif
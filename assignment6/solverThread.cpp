@@ -0,0 +1,147 @@
+#include "solverThread.h"
+
+solverThread::solverThread() {
+	state = NULL;
+	running = false;
+	ended = false;
+	solved = false;
+	discarded = false;
+	quit = false;
+	progressCount = 0;
+	progressSeen = 0;
+	cancelled = false;
+	thread = std::thread( &solverThread::workerMain, this );
+}
+
+solverThread::~solverThread() {
+	{
+		std::lock_guard<std::mutex> guard( lock );
+		quit = true;
+		cancelled = true;
+	}
+	wake.notify_one();
+	thread.join();
+	delete state;
+}
+
+bool solverThread::submit( const cubeModel & cube, const jobFunc & func ) {
+	std::lock_guard<std::mutex> guard( lock );
+	if( running ) {
+		return false;
+	}
+	delete state;
+	state = new cubeModel( cube );
+	job = func;
+	running = true;
+	ended = false;
+	solved = false;
+	discarded = false;
+	best.clear();
+	streamed.clear();
+	progress.clear();
+	started = std::chrono::steady_clock::now();
+	cancelled = false;
+	wake.notify_one();
+	return true;
+}
+
+void solverThread::cancel() {
+	cancelled = true;
+}
+
+void solverThread::discard() {
+	std::lock_guard<std::mutex> guard( lock );
+	if( running ) {
+		discarded = true;
+		cancelled = true;
+		best.clear();
+		streamed.clear();
+	}
+}
+
+bool solverThread::isBusy() {
+	std::lock_guard<std::mutex> guard( lock );
+	return running;
+}
+
+int solverThread::getElapsed() {
+	std::lock_guard<std::mutex> guard( lock );
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - started ).count();
+}
+
+solverThread::Status solverThread::poll( std::vector<cubeModel::move> & moves ) {
+	std::lock_guard<std::mutex> guard( lock );
+	if( !running ) {
+		return IDLE;
+	}
+	if( !discarded ) {
+		moves.insert( moves.end(), streamed.begin(), streamed.end() );
+	}
+	streamed.clear();
+	if( !ended ) {
+		return RUNNING;
+	}
+
+	//Job is over, hand out its best solution and free the worker
+	running = false;
+	if( discarded ) {
+		return IDLE;
+	}
+	if( !best.empty() ) {
+		moves.insert( moves.end(), best.begin(), best.end() );
+		return FINISHED;
+	}
+	return solved ? FINISHED : FAILED;
+}
+
+bool solverThread::getProgress( std::string & text ) {
+	std::lock_guard<std::mutex> guard( lock );
+	if( progressSeen == progressCount || discarded ) {
+		return false;
+	}
+	progressSeen = progressCount;
+	text = progress;
+	return true;
+}
+
+void solverThread::setBest( const cubeModel::move * moves, int count ) {
+	std::lock_guard<std::mutex> guard( lock );
+	if( !discarded ) {
+		best.assign( moves, moves + count );
+	}
+}
+
+void solverThread::stream( const cubeModel::move * moves, int count ) {
+	std::lock_guard<std::mutex> guard( lock );
+	if( !discarded ) {
+		streamed.insert( streamed.end(), moves, moves + count );
+	}
+}
+
+void solverThread::setProgress( const std::string & text ) {
+	std::lock_guard<std::mutex> guard( lock );
+	progress = text;
+	progressCount++;
+}
+
+void solverThread::workerMain() {
+	std::unique_lock<std::mutex> guard( lock );
+	while( true ) {
+		while( !quit && !job ) {
+			wake.wait( guard );
+		}
+		if( quit ) {
+			return;
+		}
+		jobFunc func;
+		func.swap( job );
+
+		//Run the job without the lock so the main thread can poll
+		guard.unlock();
+		bool result = func( *state, *this );
+		guard.lock();
+		solved = result;
+		ended = true;
+	}
+}
@@ -0,0 +1,133 @@
+//Header file for Rubiks cube project
+#ifndef SOLVERTHREAD_H
+#define SOLVERTHREAD_H
+#include "cubeModel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Background thread that runs solves, so a slow solve (or loading the
+ * tables the first time) never holds up the GLUT callbacks.
+ *
+ * The main thread submits a copy of the cube with a job function and
+ * calls poll() from idle() to collect the result.  While it runs, a job
+ * reports back through the worker:
+ *	- setBest() replaces the best solution found so far.  It is handed to
+ *	  the main thread when the job ends, including when it was cancelled,
+ *	  so a job may keep looking for shorter solutions until told to stop.
+ *	- stream() hands over moves that are final, such as those of the
+ *	  reduction solver, which poll() passes on while the job still runs.
+ *	- setProgress() describes what the job is doing.
+ * Jobs should check isCancelled() often and return soon after it is set.
+ */
+class solverThread {
+public:
+	/*
+	 * Job function.  Runs on the worker thread with its own copy of the
+	 * cube.  Returns false if the cube could not be solved.
+	 */
+	typedef std::function<bool( const cubeModel & state, solverThread & worker )> jobFunc;
+
+	enum Status {
+		IDLE,		//No job
+		RUNNING,	//Job still running
+		FINISHED,	//Job ended, the rest of its solution was returned
+		FAILED		//Job ended without a solution
+	};
+
+	/*
+	 * Starts the worker thread.
+	 */
+	solverThread();
+
+	/*
+	 * Destructor.  Cancels any running job and joins the worker.
+	 */
+	~solverThread();
+
+	/*
+	 * Starts a job on a copy of state.  Returns false if a job is still
+	 * running or has results that were not polled yet.
+	 */
+	bool submit( const cubeModel & state, const jobFunc & job );
+
+	/*
+	 * Asks the running job to stop.  Its best solution so far is still
+	 * returned by poll().
+	 */
+	void cancel();
+
+	/*
+	 * Stops the running job and throws away its results, for when the
+	 * cube it was solving has changed.
+	 */
+	void discard();
+
+	/*
+	 * Returns whether a job is running or has results left to poll.
+	 */
+	bool isBusy();
+
+	/*
+	 * Milliseconds since the current job was submitted.
+	 */
+	int getElapsed();
+
+	/*
+	 * Appends the moves that are ready to moves and returns the state of
+	 * the job.  Once a job has returned FINISHED or FAILED the worker is
+	 * free for the next one.
+	 */
+	Status poll( std::vector<cubeModel::move> & moves );
+
+	/*
+	 * Copies the progress text of the job into text if it changed since
+	 * the last call.  Returns whether it changed.
+	 */
+	bool getProgress( std::string & text );
+
+	//Called by jobs on the worker thread
+
+	bool isCancelled() const { return cancelled.load( std::memory_order_relaxed ); }
+
+	/*
+	 * Flag set by cancel(), for solvers that check it themselves.
+	 */
+	const std::atomic<bool> * getCancelFlag() const { return &cancelled; }
+
+	void setBest( const cubeModel::move * moves, int count );
+	void stream( const cubeModel::move * moves, int count );
+	void setProgress( const std::string & text );
+
+private:
+	std::thread thread;
+	std::mutex lock;				//Guards the fields below
+	std::condition_variable wake;	//New job or shutdown
+	jobFunc job;					//Job to run, empty if none waiting
+	cubeModel * state;				//Copy of the cube for the job
+	bool running;					//Job submitted and not polled to the end
+	bool ended;						//Job function returned
+	bool solved;					//Job function returned true
+	bool discarded;					//Results are thrown away
+	bool quit;
+	std::vector<cubeModel::move> best;		//Best solution so far
+	std::vector<cubeModel::move> streamed;	//Final moves not polled yet
+	std::string progress;
+	int progressCount;				//Number of progress updates
+	int progressSeen;				//Updates returned by getProgress()
+	std::chrono::steady_clock::time_point started;	//Submit time
+	std::atomic<bool> cancelled;
+
+	void workerMain();
+
+	//Not copyable
+	solverThread( const solverThread & );
+	solverThread & operator=( const solverThread & );
+};
+#endif
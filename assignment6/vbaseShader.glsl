@@ -0,0 +1,66 @@
+#version 150
+
+layout(std140, row_major) uniform Camera {
+  mat4 view;
+  mat4 projection;
+};
+
+uniform int axis;		//Axis of the turn, 0 = x, 1 = y, 2 = z
+uniform int first;		//Turning layers, none if first > last
+uniform int last;
+uniform float angle;	//Angle of the turn so far in degrees
+uniform int dim;		//Dimensions of the cube
+uniform int visible;	//Bit side: side faces the camera, bit 6 + side: its turning part does
+uniform vec4 color;
+
+//One instance per cubie on the surface of the cube
+in  vec4 vPosition;
+in  vec3 vCubie;		//Cell coordinates, x right, y up, z towards the front
+out vec4 fColor;
+
+//Rotates a point or direction counterclockwise about the turn axis
+vec4 turnLayer( vec4 p )
+{
+  float c = cos( radians( angle ) );
+  float s = sin( radians( angle ) );
+  if( axis == 0 ) {
+    return vec4( p.x, c * p.y - s * p.z, s * p.y + c * p.z, p.w );
+  }
+  if( axis == 1 ) {
+    return vec4( c * p.x + s * p.z, p.y, c * p.z - s * p.x, p.w );
+  }
+  return vec4( c * p.x - s * p.y, s * p.x + c * p.y, p.z, p.w );
+}
+
+void main() 
+{
+  float size = 1.0 / float( dim );
+  int layer = int( vCubie[axis] );
+  bool turning = layer >= first && layer <= last;
+
+  fColor = color;
+
+  //Only draw cubies with an outer side facing towards camera.
+  //Sides are numbered like cubeModel faces: 5 - 2 * axis - positive
+  int shift = turning ? 6 : 0;
+  bool facing = false;
+  for( int a = 0; a < 3; a++ ) {
+    if( vCubie[a] < 0.5 ) {
+      facing = facing || ( visible & ( 1 << ( shift + 5 - 2 * a ) ) ) != 0;
+    }
+    if( vCubie[a] > float( dim ) - 1.5 ) {
+      facing = facing || ( visible & ( 1 << ( shift + 4 - 2 * a ) ) ) != 0;
+    }
+  }
+  if( !facing ) {
+    gl_Position = vec4( 0.0, 0.0, 2.0, 1.0 );
+    return;
+  }
+
+  vec3 center = ( vCubie + 0.5 ) * size - 0.5;
+  vec4 position = vec4( vPosition.xyz * size + center, 1.0 );
+  if( turning ) {
+    position = turnLayer( position );
+  }
+  gl_Position = projection * view * position;
+} 
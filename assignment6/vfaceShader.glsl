@@ -1,15 +1,67 @@
 #version 150
 
-uniform mat4 view;
-uniform mat4 projection;
-uniform vec4 color;
-uniform mat4 model;
+layout(std140, row_major) uniform Camera {
+  mat4 view;
+  mat4 projection;
+};
 
+uniform mat4 sides[6];		//Rotation from the front face to each side
+uniform int axis;			//Axis of the turn, 0 = x, 1 = y, 2 = z
+uniform int first;			//Turning layers, none if first > last
+uniform int last;
+uniform float angle;		//Angle of the turn so far in degrees
+uniform int dim;			//Dimensions of the cube
+uniform int cursor;			//Sticker under the cursor, -1 for none
+uniform int visible;		//Bit side: side faces the camera, bit 6 + side: its turning part does
+uniform vec4 palette[6];	//Color of each palette index
+
+//One instance per sticker, numbered like cubeModel stickers
 in  vec4 vPosition;
+in  float vColor;			//Palette index
+in  float vFlags;			//1: hinted
 out vec4 fColor;
+out float fCursor;
+
+//Rotates a point or direction counterclockwise about the turn axis
+vec4 turnLayer( vec4 p )
+{
+  float c = cos( radians( angle ) );
+  float s = sin( radians( angle ) );
+  if( axis == 0 ) {
+    return vec4( p.x, c * p.y - s * p.z, s * p.y + c * p.z, p.w );
+  }
+  if( axis == 1 ) {
+    return vec4( c * p.x + s * p.z, p.y, c * p.z - s * p.x, p.w );
+  }
+  return vec4( c * p.x - s * p.y, s * p.x + c * p.y, p.z, p.w );
+}
 
 void main() 
 {
-  fColor = color;
-  gl_Position = projection * view * model * vPosition;
+  int side = gl_InstanceID / ( dim * dim );
+  int row = ( gl_InstanceID / dim ) % dim;
+  int column = gl_InstanceID % dim;
+  float size = 1.0 / float( dim );
+
+  fColor = palette[int( vColor )];
+  fCursor = ( gl_InstanceID == cursor || ( int( vFlags ) & 1 ) != 0 ) ? 1.0 : 0.0;
+
+  //Layer of the sticker along the turn axis, from its cell coordinate
+  vec3 center = vec3( ( float( column ) + 0.5 ) * size - 0.5, 0.5 - ( float( row ) + 0.5 ) * size, 0.51 );
+  vec4 cell = sides[side] * vec4( center, 1.0 );
+  int layer = clamp( int( floor( ( cell[axis] + 0.5 ) * float( dim ) ) ), 0, dim - 1 );
+  bool turning = layer >= first && layer <= last;
+
+  //Only draw stickers facing towards camera, decided for each side
+  if( ( visible & ( 1 << ( turning ? side + 6 : side ) ) ) == 0 ) {
+    gl_Position = vec4( 0.0, 0.0, 2.0, 1.0 );
+    return;
+  }
+
+  //Stickers are slightly smaller than the cubes behind them
+  vec4 position = sides[side] * vec4( vPosition.xyz * size * 0.9 + center, 1.0 );
+  if( turning ) {
+    position = turnLayer( position );
+  }
+  gl_Position = projection * view * position;
 } 
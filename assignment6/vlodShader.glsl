@@ -0,0 +1,66 @@
+#version 150
+
+layout(std140, row_major) uniform Camera {
+  mat4 view;
+  mat4 projection;
+};
+
+uniform mat4 sides[6];		//Rotation from the front face to each side
+uniform int axis;			//Axis of the turn, 0 = x, 1 = y, 2 = z
+uniform int first;			//Turning layers, the whole cube without a turn
+uniform int last;
+uniform float angle;		//Angle of the turn so far in degrees
+uniform int dim;			//Dimensions of the cube
+
+//One instance per side of each block: layers below the turn, the turning
+//layers and layers above it
+in  vec4 vPosition;
+out vec2 fSticker;			//Column and row of the sticker on the side
+flat out int fSide;			//Side of the cube, -1 for faces cut by the turn
+
+//Rotates a point or direction counterclockwise about the turn axis
+vec4 turnLayer( vec4 p )
+{
+  float c = cos( radians( angle ) );
+  float s = sin( radians( angle ) );
+  if( axis == 0 ) {
+    return vec4( p.x, c * p.y - s * p.z, s * p.y + c * p.z, p.w );
+  }
+  if( axis == 1 ) {
+    return vec4( c * p.x + s * p.z, p.y, c * p.z - s * p.x, p.w );
+  }
+  return vec4( c * p.x - s * p.y, s * p.x + c * p.y, p.z, p.w );
+}
+
+void main() 
+{
+  int block = gl_InstanceID / 6;
+  int side = gl_InstanceID % 6;
+
+  //Cell coordinates of the block along the turn axis
+  float low = block == 0 ? 0.0 : float( block == 1 ? first : last + 1 );
+  float high = block == 0 ? float( first ) : float( block == 1 ? last + 1 : dim );
+  if( high <= low ) {
+    gl_Position = vec4( 0.0, 0.0, 2.0, 1.0 );
+    return;
+  }
+
+  //Side of the whole cube, squeezed to the block along the axis
+  vec4 corner = sides[side] * vec4( vPosition.xy, 0.5, 1.0 );
+  vec3 lower = vec3( 0.0 );
+  vec3 upper = vec3( 1.0 );
+  lower[axis] = low / float( dim );
+  upper[axis] = high / float( dim );
+  vec4 position = vec4( mix( lower, upper, corner.xyz + 0.5 ) - 0.5, 1.0 );
+
+  //Sides are rotations, so the transpose takes the point back to the
+  //front face.  Faces inside the cube were cut by the turn.
+  vec4 local = transpose( sides[side] ) * position;
+  fSticker = vec2( local.x + 0.5, 0.5 - local.y ) * float( dim );
+  fSide = local.z > 0.5 - 0.5 / float( dim ) ? side : -1;
+
+  if( block == 1 ) {
+    position = turnLayer( position );
+  }
+  gl_Position = projection * view * position;
+} 
@@ -1,7 +1,9 @@
 #version 150
 
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140, row_major) uniform Camera {
+  mat4 view;
+  mat4 projection;
+};
 uniform vec4 color;
 uniform mat4 model;
 
@@ -2,8 +2,10 @@
 
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140, row_major) uniform Camera {
+  mat4 view;
+  mat4 projection;
+};
 in  vec4 vPosition;
 out vec3 fTexCoord;
 
@@ -5,8 +5,10 @@
 //
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140, row_major) uniform Camera {
+  mat4 view;
+  mat4 projection;
+};
 
 uniform mat3 normalMatrix;
 uniform vec4 mLight;  //moveable light
@@ -0,0 +1,108 @@
+#include "workPool.h"
+
+workPool::workPool( int count ) {
+	if( count <= 0 ) {
+		count = std::thread::hardware_concurrency();
+	}
+	if( count <= 0 ) {
+		count = 1;
+	}
+	queues = new queue[count];
+	func = NULL;
+	batch = 0;
+	running = 0;
+	quit = false;
+	cancelled = false;
+	for( int i = 0; i < count; i++ ) {
+		threads.push_back( std::thread( &workPool::workerMain, this, i ) );
+	}
+}
+
+workPool::~workPool() {
+	{
+		std::lock_guard<std::mutex> guard( lock );
+		quit = true;
+	}
+	start.notify_all();
+	for( size_t i = 0; i < threads.size(); i++ ) {
+		threads[i].join();
+	}
+	delete [] queues;
+}
+
+void workPool::run( int count, const taskFunc & task ) {
+	if( count <= 0 ) {
+		return;
+	}
+	//Deal tasks out in order so early tasks start first on every worker
+	int numThreads = getThreads();
+	for( int i = 0; i < count; i++ ) {
+		queues[i % numThreads].tasks.push_back( i );
+	}
+
+	std::unique_lock<std::mutex> guard( lock );
+	cancelled = false;
+	func = &task;
+	running = numThreads;
+	batch++;
+	start.notify_all();
+	while( running > 0 ) {
+		done.wait( guard );
+	}
+	func = NULL;
+}
+
+void workPool::cancel() {
+	cancelled = true;
+}
+
+bool workPool::nextTask( int id, int & task ) {
+	int numThreads = getThreads();
+	for( int i = 0; i < numThreads; i++ ) {
+		queue & q = queues[( id + i ) % numThreads];
+		std::lock_guard<std::mutex> guard( q.lock );
+		if( q.tasks.empty() ) {
+			continue;
+		}
+		if( i == 0 ) {
+			task = q.tasks.front();
+			q.tasks.pop_front();
+		}
+		else {
+			task = q.tasks.back();
+			q.tasks.pop_back();
+		}
+		return true;
+	}
+	return false;
+}
+
+void workPool::workerMain( int id ) {
+	int seen = 0;
+	for( ;; ) {
+		const taskFunc * task;
+		{
+			std::unique_lock<std::mutex> guard( lock );
+			while( !quit && batch == seen ) {
+				start.wait( guard );
+			}
+			if( quit ) {
+				return;
+			}
+			seen = batch;
+			task = func;
+		}
+
+		int t;
+		while( nextTask( id, t ) ) {
+			if( !cancelled ) {
+				( *task )( id, t );
+			}
+		}
+
+		std::lock_guard<std::mutex> guard( lock );
+		if( --running == 0 ) {
+			done.notify_all();
+		}
+	}
+}
@@ -0,0 +1,84 @@
+//Header file for Rubiks cube project
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed set of worker threads that run batches of numbered tasks.
+ *
+ * Each worker gets its own queue of task numbers.  A worker takes tasks
+ * from the front of its queue and, once it runs dry, steals from the back
+ * of another worker's queue, so uneven tasks (such as search subtrees of
+ * very different size) still keep every thread busy.
+ */
+class workPool {
+public:
+	/*
+	 * Task function: called with the worker number and the task number.
+	 */
+	typedef std::function<void( int worker, int task )> taskFunc;
+
+	/*
+	 * Starts the workers.  threads = 0 uses one per hardware thread.
+	 */
+	workPool( int threads = 0 );
+
+	/*
+	 * Destructor.  Stops and joins the workers.
+	 */
+	~workPool();
+
+	/*
+	 * Runs tasks 0..count-1 and returns when all have finished or the
+	 * batch was cancelled.  Only one batch runs at a time.
+	 */
+	void run( int count, const taskFunc & func );
+
+	/*
+	 * Drops the tasks of the running batch that have not started yet.
+	 * May be called from inside a task.
+	 */
+	void cancel();
+
+	/*
+	 * Returns the number of worker threads.
+	 */
+	int getThreads() const { return (int)threads.size(); }
+
+private:
+	struct queue {
+		std::mutex lock;
+		std::deque<int> tasks;
+	};
+
+	std::vector<std::thread> threads;
+	queue * queues;
+
+	std::mutex lock;				//Guards the fields below
+	std::condition_variable start;	//New batch or shutdown
+	std::condition_variable done;	//Last worker finished a batch
+	const taskFunc * func;			//Task function of the running batch
+	int batch;						//Number of the running batch
+	int running;					//Workers still in the running batch
+	bool quit;
+	std::atomic<bool> cancelled;
+
+	void workerMain( int id );
+
+	/*
+	 * Next task for a worker: its own queue first, then stealing.
+	 * Returns false when no tasks are left.
+	 */
+	bool nextTask( int id, int & task );
+
+	//Not copyable
+	workPool( const workPool & );
+	workPool & operator=( const workPool & );
+};
+#endif